@@ -37,9 +37,12 @@
 #include "interfaces/protocol/ProtocolTypeDef.h"
 #include "tbb/concurrent_unordered_map.h"
 #include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_vector.h>
 #include <tbb/spin_mutex.h>
 #include <boost/function.hpp>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <future>
@@ -56,6 +59,9 @@ namespace precompiled
 {
 class Precompiled;
 struct PrecompiledExecResult;
+class ParallelConfigCache;
+class ParallelConfigPrecompiled;
+struct ParsedParallelConfig;
 }  // namespace precompiled
 namespace wasm
 {
@@ -66,14 +72,38 @@ namespace executor
 enum ExecutorVersion : int32_t
 {
     Version_3_0_0 = 1,
+    // the transactions without conflict fields are executed optimistically instead of being sent
+    // back, see optimisticExecuteTransactions. The critical keys are extracted from the calldata
+    // and the functions with array or tuple critical params are not parallel, see getTxCriticals.
+    // The executor doesn't choose the version, the gates compare the version of the block header,
+    // which the sealer writes and the consensus signs, so every node switches at the same block
+    // once the chain is configured to seal version 2. Until then the blocks keep the 3.0.0 path.
+    // A transaction which opens or creates a table is untracked by the optimistic execution and
+    // always falls back to the serial execution, see SyncStorageWrapper
+    Version_3_1_0 = 2,
+};
+
+// Scheduler used by DAG execution. Classic is the original shared queue polled under a mutex,
+// WorkStealing gives every worker its own deque and parks idle workers, CriticalPath always runs
+// the ready transaction with the longest remaining dependency chain.
+enum class DAGSchedulerType : int32_t
+{
+    Classic = 0,
+    WorkStealing = 1,
+    CriticalPath = 2,
 };
 
 class TransactionExecutive;
+class TxDAG;
+struct BlockCriticals;
+struct CriticalKey;
 class BlockContext;
 class PrecompiledContract;
+class PrecompiledRegistry;
 template <typename T, typename V>
 class ClockCache;
 struct FunctionAbi;
+struct CachedFunctionAbi;
 struct CallParameters;
 
 using executionCallback = std::function<void(
@@ -136,7 +166,33 @@ public:
     void getCode(std::string_view contract,
         std::function<void(bcos::Error::Ptr, bcos::bytes)> callback) override;
 
-    std::vector<std::string> getTxCriticals(const CallParameters& params);
+    // The constant precompiled contract at address, null if there is none. Without an executive,
+    // for classifying transactions
+    std::shared_ptr<precompiled::Precompiled> getPrecompiled(const std::string& address) const;
+
+    // Append the critical keys of a transaction to criticals, nothing if it is not parallel
+    void getTxCriticals(const CallParameters& params, std::vector<CriticalKey>& criticals);
+
+    void setDAGSchedulerType(DAGSchedulerType _type) { m_dagSchedulerType = _type; }
+    DAGSchedulerType dagSchedulerType() const { return m_dagSchedulerType; }
+
+    // Hard deadline of the DAG execution of a block, 0 means no deadline. The execution of a block
+    // which passes it fails with DAG_ERROR, partial results would depend on timing.
+    void setDAGExecutionTimeout(std::chrono::milliseconds _timeout)
+    {
+        m_dagExecutionTimeout = _timeout;
+    }
+
+    // Stop dispatching transactions of the running block execution, which fails with DAG_ERROR.
+    // A cancellation when no block is executing is for none, it is reset by the next execution.
+    void cancelDAGExecution();
+
+    // Execute a block in chunks of _chunkSize transactions, 0 means in one piece. The payloads and
+    // conflicts of a chunk are analysed while the chunks before it are executing, the chunks are
+    // executed one after another in block order, and the optimistic transactions after all of
+    // them, so the result is the same for any chunk size.
+    void setDAGPipelineChunkSize(size_t _chunkSize) { m_dagPipelineChunkSize = _chunkSize; }
+    size_t dagPipelineChunkSize() const { return m_dagPipelineChunkSize; }
 
 private:
     std::shared_ptr<BlockContext> createBlockContext(
@@ -168,6 +224,11 @@ private:
     std::unique_ptr<CallParameters> createCallParameters(
         bcos::protocol::ExecutionMessage& input, const bcos::protocol::Transaction& tx);
 
+    // Load the ParallelConfig of (receiveAddress, selector) from the cp_ table, null if the
+    // function is not parallel
+    std::shared_ptr<const precompiled::ParsedParallelConfig> loadParallelConfig(
+        const std::string& receiveAddress, uint32_t selector, const std::string& origin);
+
     std::optional<std::vector<bcos::bytes>> decodeConflictFields(
         const FunctionAbi& functionAbi, const CallParameters& prams);
 
@@ -186,7 +247,59 @@ private:
             bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
             callback);
 
+    // Criticals of the EVM transactions, the ones without criticals are SEND_BACK, or appended to
+    // optimisticIndexes in optimistic execution
+    BlockCriticals analyseEvmTransactions(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        gsl::span<const bcos::crypto::HashType> txHashList,
+        gsl::span<bcos::protocol::ExecutionMessage::UniquePtr> executionResults,
+        std::vector<gsl::index>& optimisticIndexes);
+
+    // Criticals of the WASM transactions from the conflict fields of their ABI, the ones without
+    // conflict fields are SEND_BACK
+    BlockCriticals analyseWasmTransactions(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        gsl::span<const bcos::crypto::HashType> txHashList,
+        gsl::span<bcos::protocol::ExecutionMessage::UniquePtr> executionResults);
+
+    // Execute the analysed transactions, throw if the DAG execution is stopped before the end
+    void executeAnalysedTransactions(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        const BlockCriticals& criticals, const std::vector<gsl::index>& optimisticIndexes,
+        gsl::span<const bcos::crypto::HashType> txHashList,
+        gsl::span<bcos::protocol::ExecutionMessage::UniquePtr> executionResults,
+        std::chrono::steady_clock::time_point deadline);
+
+    // Undo the writes of the DAG transactions of the failed block execution and drop their
+    // executives, so that the block can be executed again on the same state
+    void rollbackDAGExecution();
+
+    // time_point::max() if there is no DAG execution timeout
+    std::chrono::steady_clock::time_point dagDeadline(
+        std::chrono::steady_clock::time_point start) const;
+
+    // Execute the block in chunks of m_dagPipelineChunkSize, prepare(begin, end) fills the inputs
+    // of a chunk before its analysis
+    void pipelineExecuteTransactions(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        const bcos::crypto::HashList& txHashList, std::function<void(size_t, size_t)> prepare,
+        std::function<void(
+            bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
+            callback);
+
+    // Execute the transactions which have criticals on the conflict graph of the criticals, shared
+    // by the EVM and WASM front-ends, throw if the execution can't be started or is stopped
+    std::shared_ptr<TxDAG> executeDAG(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        const BlockCriticals& criticals, gsl::span<const bcos::crypto::HashType> txHashList,
+        gsl::span<bcos::protocol::ExecutionMessage::UniquePtr> executionResults,
+        std::chrono::steady_clock::time_point deadline);
+
+    // Execute inputs[indexes] optimistically after the DAG transactions, only the ones before the
+    // first SEND_BACK transaction of the block are committed, so that the order is the same as
+    // without optimistic execution. The first one which calls another contract and all the ones
+    // after it are SEND_BACK.
+    void optimisticExecuteTransactions(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        const std::vector<gsl::index>& indexes, gsl::span<const bcos::crypto::HashType> txHashList,
+        gsl::span<bcos::protocol::ExecutionMessage::UniquePtr> executionResults);
+
     void dagExecuteTransactionsForWasm(gsl::span<std::unique_ptr<CallParameters>> inputs,
+        const bcos::crypto::HashList& txHashList,
         std::function<void(
             bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
             callback);
@@ -200,7 +313,9 @@ private:
     bool m_isWasm = false;
     bool m_isAuthCheck = false;
     const ExecutorVersion m_version;
-    std::shared_ptr<ClockCache<bcos::bytes, FunctionAbi>> m_abiCache;
+    std::shared_ptr<ClockCache<bcos::bytes, CachedFunctionAbi>> m_abiCache;
+    std::shared_ptr<precompiled::ParallelConfigCache> m_parallelConfigCache;
+    std::shared_ptr<precompiled::ParallelConfigPrecompiled> m_parallelConfigPrecompiled;
 
     struct State
     {
@@ -243,11 +358,17 @@ private:
     tbb::concurrent_hash_map<std::tuple<int64_t, int64_t>, CallState, HashCombine> m_calledContext;
     std::shared_mutex m_stateStoragesMutex;
 
-    std::shared_ptr<std::map<std::string, std::shared_ptr<PrecompiledContract>>>
-        m_precompiledContract;
-    std::map<std::string, std::shared_ptr<precompiled::Precompiled>> m_constantPrecompiled;
-    std::shared_ptr<const std::set<std::string>> m_builtInPrecompiled;
+    // immutable after initPrecompiled(), shared by all the executives
+    std::shared_ptr<const PrecompiledRegistry> m_precompiledRegistry;
     unsigned int m_DAGThreadNum = std::max(std::thread::hardware_concurrency(), (unsigned int)1);
+    DAGSchedulerType m_dagSchedulerType = DAGSchedulerType::WorkStealing;
+    std::chrono::milliseconds m_dagExecutionTimeout = std::chrono::milliseconds(0);
+    size_t m_dagPipelineChunkSize = 0;
+    std::atomic_bool m_dagCancelled = {false};
+    std::weak_ptr<TxDAG> m_runningDAG;
+    // the executives dispatched by the DAG executions of the current block execution, in order
+    tbb::concurrent_vector<std::shared_ptr<TransactionExecutive>> m_dagExecutives;
+    std::mutex x_runningDAG;
     std::shared_ptr<wasm::GasInjector> m_gasInjector = nullptr;
 };
 
@@ -56,6 +56,17 @@ struct ParameterAbi
         this->components = components;
     }
 
+    // Approximate heap and object size, used as the charge in the ABI cache
+    size_t memorySize() const
+    {
+        auto size = sizeof(ParameterAbi) + type.capacity();
+        for (auto& component : components)
+        {
+            size += component.memorySize();
+        }
+        return size;
+    }
+
     friend std::ostream& operator<<(std::ostream& output, const ParameterAbi& param)
     {
         output << "{\"type\": " << param.type << ", \"components\": [";
@@ -74,8 +85,32 @@ struct FunctionAbi
     std::vector<ParameterAbi> inputs;
     std::vector<ConflictField> conflictFields;
 
+    size_t memorySize() const
+    {
+        auto size = sizeof(FunctionAbi) + name.capacity();
+        for (auto& input : inputs)
+        {
+            size += input.memorySize();
+        }
+        for (auto& conflictField : conflictFields)
+        {
+            size += sizeof(ConflictField) + conflictField.accessPath.capacity();
+        }
+        return size;
+    }
+
     static std::unique_ptr<FunctionAbi> deserialize(
         std::string_view abiStr, const bcos::bytes& expected, bcos::crypto::Hash::Ptr hashImpl);
 };
+
+// An entry of the ABI cache. A null abi is a negative entry: the ABI of the contract is stored
+// but has no valid entry of the function. The ABI of a deployed contract never changes, so that
+// a negative entry only depends on the state, a contract without ABI is not cached at all.
+struct CachedFunctionAbi
+{
+    std::unique_ptr<FunctionAbi> abi;
+
+    size_t memorySize() const { return sizeof(CachedFunctionAbi) + (abi ? abi->memorySize() : 0); }
+};
 }  // namespace executor
 }  // namespace bcos
\ No newline at end of file
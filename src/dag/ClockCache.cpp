@@ -30,10 +30,15 @@ using namespace std;
 using namespace bcos;
 using namespace bcos::executor;
 
-CacheItem* CacheShard::insert(size_t hash, void* value, bool holdReference)
+CacheItem* CacheShard::insert(
+    size_t hash, void* key, void* value, size_t charge, bool holdReference)
 {
     auto guard = lock_guard<mutex>(m_mutex);
-    auto success = evictFromCache();
+    if (charge > m_capacity.load(memory_order_relaxed))
+    {
+        return nullptr;
+    }
+    auto success = evictFromCache(charge);
     if (!success)
     {
         return nullptr;
@@ -53,50 +58,82 @@ CacheItem* CacheShard::insert(size_t hash, void* value, bool holdReference)
         item = &m_list.back();
     }
 
-    item->hash = hash;
+    item->hash.store(hash, std::memory_order_relaxed);
+    item->key = key;
     item->value = value;
+    item->charge = charge;
     auto flags = holdReference ? s_inCacheBit + s_oneRef : s_inCacheBit;
 
-    item->flags.store(flags, std::memory_order_relaxed);
-    HashTable::accessor accessor;
-    if (m_table.find(accessor, hash))
+    // Use release semantics, a lookup which refs the item has to see its key and value.
+    item->flags.store(flags, std::memory_order_release);
+    // Eviction moves the items in the table, so that find the slot after it.
+    auto table = m_table.load(std::memory_order_relaxed);
+    auto slot = findSlot(hash);
+    auto existingItem = table->slots[slot].load(std::memory_order_relaxed);
+    table->slots[slot].store(item, std::memory_order_release);
+    if (existingItem != nullptr)
+    {
+        unsetInCache(existingItem);
+    }
+    else if (++m_tableItems * 2 > table->mask + 1)
     {
-        auto existingHandle = accessor->second;
-        m_table.erase(accessor);
-        unsetInCache(existingHandle);
+        growTable();
     }
-    m_table.insert(HashTable::value_type(hash, item));
-    m_usage.fetch_add(1, std::memory_order_relaxed);
+    m_usage.fetch_add(charge, std::memory_order_relaxed);
     return item;
 }
 
-CacheItem* CacheShard::lookup(size_t hash)
+CacheItem* CacheShard::find(size_t hash, const void* key)
 {
-    HashTable::const_accessor accessor;
-    if (!m_table.find(accessor, hash))
+    auto table = m_table.load(std::memory_order_acquire);
+    for (auto slot = table->home(hash);; slot = (slot + 1) & table->mask)
     {
-        return nullptr;
+        CacheItem* item = table->slots[slot].load(std::memory_order_acquire);
+        if (item == nullptr)
+        {
+            return nullptr;
+        }
+        if (item->hash.load(std::memory_order_relaxed) != hash)
+        {
+            continue;
+        }
+
+        // ref() could fail if another thread sneak in and evict/erase the cache
+        // entry before we are able to hold reference.
+        if (!ref(item))
+        {
+            return nullptr;
+        }
+
+        // Double check the key since the item may now representing another key
+        // if other threads sneak in, evict/erase the entry and re-used the item
+        // for another cache entry, or the item is of another key with the same hash.
+        if (hash != item->hash.load(std::memory_order_relaxed) || !m_keyEqual(item->key, key))
+        {
+            unref(item, false);
+            return nullptr;
+        }
+        return item;
     }
+}
+
+CacheItem* CacheShard::lookup(size_t hash, const void* key)
+{
+    auto item = find(hash, key);
+    recordLookup(item != nullptr);
+    return item;
+}
 
-    CacheItem* item = accessor->second;
-    accessor.release();
-    // ref() could fail if another thread sneak in and evict/erase the cache
-    // entry before we are able to hold reference.
-    if (!ref(item))
+void CacheShard::recordLookup(bool hit)
+{
+    if (hit)
     {
-        return nullptr;
+        m_hits.increase();
     }
     else
-
-        // Double check the key since the item may now representing another key
-        // if other threads sneak in, evict/erase the entry and re-used the item
-        // for another cache entry.
-        if (hash != item->hash)
     {
-        unref(item, false);
-        return nullptr;
+        m_misses.increase();
     }
-    return item;
 }
 
 bool CacheShard::ref(CacheItem* item)
@@ -154,7 +191,7 @@ void CacheShard::unsetInCache(CacheItem* item)
     }
 }
 
-bool CacheShard::evictFromCache()
+bool CacheShard::evictFromCache(size_t charge)
 {
     assert(!m_mutex.try_lock());
     auto usage = m_usage.load(std::memory_order_relaxed);
@@ -166,7 +203,7 @@ bool CacheShard::evictFromCache()
 
     auto newHead = m_head;
     bool is2ndIteration = false;
-    while (usage >= capacity)
+    while (usage + charge > capacity)
     {
         assert(newHead < m_list.size());
         auto evicted = tryEvict(&m_list[newHead]);
@@ -201,9 +238,11 @@ bool CacheShard::tryEvict(CacheItem* item)
     if (item->flags.compare_exchange_strong(
             flags, 0, std::memory_order_acquire, std::memory_order_relaxed))
     {
-        auto erased = m_table.erase(item->hash);
-        assert(erased);
+        auto slot = findSlot(item->hash.load(std::memory_order_relaxed));
+        assert(m_table.load(std::memory_order_relaxed)->slots[slot].load() == item);
+        eraseSlot(slot);
         recycleItem(item);
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
     item->flags.fetch_and(~s_usageBit, memory_order_relaxed);
@@ -216,8 +255,9 @@ void CacheShard::recycleItem(CacheItem* item)
     auto& flags = item->flags;
     assert(!inCache(flags) && refCounts(flags) == 0);
     m_deleter(item->value);
+    m_keyDeleter(item->key);
     m_recycle.push_back(item);
-    m_usage.fetch_sub(1, std::memory_order_relaxed);
+    m_usage.fetch_sub(item->charge, std::memory_order_relaxed);
 }
 
 void CacheShard::setCapacity(size_t capacity)
@@ -225,7 +265,96 @@ void CacheShard::setCapacity(size_t capacity)
     assert(capacity > 0);
     auto guard = lock_guard<mutex>(m_mutex);
     m_capacity.store(capacity, std::memory_order_relaxed);
-    evictFromCache();
+    evictFromCache(0);
+}
+
+void CacheShard::eraseAll()
+{
+    auto guard = lock_guard<mutex>(m_mutex);
+    auto table = m_table.load(std::memory_order_relaxed);
+    for (size_t slot = 0; slot <= table->mask; ++slot)
+    {
+        auto item = table->slots[slot].load(std::memory_order_relaxed);
+        if (item != nullptr)
+        {
+            table->slots[slot].store(nullptr, std::memory_order_release);
+            unsetInCache(item);
+        }
+    }
+    m_tableItems = 0;
+}
+
+CacheStats CacheShard::stats() const
+{
+    CacheStats stats;
+    stats.hits = m_hits.load();
+    stats.misses = m_misses.load();
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.usage = m_usage.load(std::memory_order_relaxed);
+    stats.capacity = m_capacity.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t CacheShard::findSlot(size_t hash) const
+{
+    auto table = m_table.load(std::memory_order_relaxed);
+    auto slot = table->home(hash);
+    while (true)
+    {
+        auto item = table->slots[slot].load(std::memory_order_relaxed);
+        if (item == nullptr || item->hash.load(std::memory_order_relaxed) == hash)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & table->mask;
+    }
+}
+
+void CacheShard::eraseSlot(size_t slot)
+{
+    auto table = m_table.load(std::memory_order_relaxed);
+    auto next = slot;
+    while (true)
+    {
+        next = (next + 1) & table->mask;
+        auto item = table->slots[next].load(std::memory_order_relaxed);
+        if (item == nullptr)
+        {
+            break;
+        }
+        // The item fills the hole if its home is not in (slot, next]. A lookup running meanwhile
+        // may miss the item, but never gets a wrong one.
+        auto home = table->home(item->hash.load(std::memory_order_relaxed));
+        if (((next - home) & table->mask) >= ((next - slot) & table->mask))
+        {
+            table->slots[slot].store(item, std::memory_order_release);
+            slot = next;
+        }
+    }
+    table->slots[slot].store(nullptr, std::memory_order_release);
+    --m_tableItems;
+}
+
+void CacheShard::growTable()
+{
+    auto oldTable = m_table.load(std::memory_order_relaxed);
+    auto table = std::make_unique<Table>((oldTable->mask + 1) * 2);
+    for (size_t i = 0; i <= oldTable->mask; ++i)
+    {
+        auto item = oldTable->slots[i].load(std::memory_order_relaxed);
+        if (item == nullptr)
+        {
+            continue;
+        }
+        auto slot = table->home(item->hash.load(std::memory_order_relaxed));
+        while (table->slots[slot].load(std::memory_order_relaxed) != nullptr)
+        {
+            slot = (slot + 1) & table->mask;
+        }
+        table->slots[slot].store(item, std::memory_order_relaxed);
+    }
+    m_table.store(table.get(), std::memory_order_release);
+    m_tables.push_back(std::move(table));
 }
 
 CacheShard::~CacheShard()
@@ -236,6 +365,7 @@ CacheShard::~CacheShard()
         if (inCache(flags) || refCounts(flags) > 0)
         {
             m_deleter(item.value);
+            m_keyDeleter(item.key);
         }
     }
 }
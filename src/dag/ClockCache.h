@@ -23,16 +23,20 @@
 #pragma once
 
 #include "Abi.h"
+#include "SingleFlight.h"
 #include "libutilities/Common.h"
-#include <tbb/concurrent_hash_map.h>
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace bcos
@@ -48,14 +52,22 @@ struct CacheItem
 
     CacheItem& operator=(const CacheItem& a)
     {
+        key = a.key;
         value = a.value;
         return *this;
     }
 
-    size_t hash;
+    // Read by lock-free lookups without holding a reference, so that it is atomic.
+    std::atomic<size_t> hash;
+
+    // The full key, compared on lookup, so that keys with the same hash never share a value.
+    void* key;
 
     void* value;
 
+    // Cost of the item against the capacity of the shard, e.g. its size in bytes.
+    size_t charge;
+
     // Flags and counters associated with the cache item:
     //   lowest bit: in-cache bit
     //   second lowest bit: usage bit
@@ -65,22 +77,85 @@ struct CacheItem
     std::atomic<uint32_t> flags;
 };
 
-// A cache shard which maintains its own clock cache.
+// Hit, miss and eviction counters of a cache, with the usage and capacity in charge units.
+struct CacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t usage = 0;
+    size_t capacity = 0;
+
+    CacheStats& operator+=(const CacheStats& stats)
+    {
+        hits += stats.hits;
+        misses += stats.misses;
+        evictions += stats.evictions;
+        usage += stats.usage;
+        capacity += stats.capacity;
+        return *this;
+    }
+};
+
+// A counter incremented by many threads, striped over cache lines so that the threads seldom
+// write the same line.
+class StripedCounter
+{
+public:
+    void increase()
+    {
+        static thread_local size_t stripe =
+            std::hash<std::thread::id>()(std::this_thread::get_id()) % STRIPE_NUM;
+        m_stripes[stripe].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const
+    {
+        uint64_t sum = 0;
+        for (auto& stripe : m_stripes)
+        {
+            sum += stripe.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    static constexpr size_t STRIPE_NUM = 16;
+    struct alignas(64) Stripe
+    {
+        std::atomic<uint64_t> value = {0};
+    };
+    std::array<Stripe, STRIPE_NUM> m_stripes;
+};
+
+// A cache shard which maintains its own clock cache. Lookups are lock-free: a probe of an
+// open-addressing table of item pointers with atomic loads, then a CAS on the reference count of
+// the item found. Writers update the table under the mutex.
 class CacheShard
 {
 public:
-    using HashTable = tbb::concurrent_hash_map<uint32_t, CacheItem*>;
     using Deleter = void (*)(void* value);
+    using KeyEqual = bool (*)(const void* key, const void* other);
 
-    CacheShard() : m_head(0), m_usage(0) {}
+    CacheShard() : m_head(0), m_usage(0)
+    {
+        m_tables.push_back(std::make_unique<Table>(INIT_TABLE_SIZE));
+        m_table.store(m_tables.back().get(), std::memory_order_release);
+    }
 
-    // Insert a mapping from key->value into the cache.
-    CacheItem* insert(size_t hash, void* value, bool holdReference);
+    // Insert a mapping from key->value into the cache, which costs charge of the capacity. The
+    // shard owns key and value once inserted. A key with the same hash as a cached one replaces
+    // it. Returns nullptr if the charge is larger than the capacity or enough space can not be
+    // evicted.
+    CacheItem* insert(size_t hash, void* key, void* value, size_t charge, bool holdReference);
 
     // If the cache has no mapping for "key", returns nullptr, otherwise return a
     // item that corresponds to the mapping. The caller must call this->unref(item)
     // when the returned mapping is no longer needed.
-    CacheItem* lookup(size_t hash);
+    CacheItem* lookup(size_t hash, const void* key);
+
+    // lookup() without counting a hit or miss, for the re-checks of a counted lookup
+    CacheItem* find(size_t hash, const void* key);
 
     // Increments the reference count for the item if it refers to an entry in
     // the cache. Returns true if refcount was incremented; otherwise, returns
@@ -98,8 +173,20 @@ public:
 
     void setCapacity(size_t capacity);
 
+    // Erase all the items from the cache, an item still referenced is recycled by its last
+    // unref()
+    void eraseAll();
+
     void setDeleter(Deleter deleter) { m_deleter = deleter; }
 
+    void setKeyFunctions(KeyEqual keyEqual, Deleter keyDeleter)
+    {
+        m_keyEqual = keyEqual;
+        m_keyDeleter = keyDeleter;
+    }
+
+    CacheStats stats() const;
+
     ~CacheShard();
 
 private:
@@ -112,6 +199,8 @@ private:
     static bool hasUsage(uint32_t flags) { return flags & s_usageBit; }
     static uint32_t refCounts(uint32_t flags) { return flags >> s_refCountOffset; }
 
+    void recordLookup(bool hit);
+
     // Unset in-cache bit of the entry. Recycle the item if necessary, returns
     // true if a value is erased.
     //
@@ -119,10 +208,10 @@ private:
     void unsetInCache(CacheItem* item);
 
     // Scan through the circular list, evict entries until we get enough space
-    // for a new cache entry. Return true if success, false otherwise.
+    // for a new cache entry of charge. Return true if success, false otherwise.
     //
     // Has to hold mutex_ before being called.
-    bool evictFromCache();
+    bool evictFromCache(size_t charge);
 
     // Examine the item for eviction. If the item is in cache, usage bit is
     // not set, and referece count is 0, evict it from cache. Otherwise unset
@@ -154,20 +243,71 @@ private:
     // Recycle bin of cache handles.
     std::vector<CacheItem*> m_recycle;
 
+    // Linear probing table of hash -> item, at most one item per hash. A slot is null or an item
+    // in cache. Items are never freed before the shard, so that a lookup can read a slot which
+    // was overwritten meanwhile, it refs the item and verifies its key before using it. A stale
+    // read is a miss, never a wrong value.
+    struct Table
+    {
+        explicit Table(size_t size) : slots(new std::atomic<CacheItem*>[size]), mask(size - 1)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        size_t home(size_t hash) const
+        {
+            // the low bits of the hash select the shard, so that mix the high bits in
+            return (hash * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+        }
+
+        std::unique_ptr<std::atomic<CacheItem*>[]> slots;
+        size_t mask;
+    };
+
+    static constexpr size_t INIT_TABLE_SIZE = 16;
+
+    // Returns the slot of the item of hash, or the empty slot ending its probe.
+    //
+    // Has to hold mutex_ before being called.
+    size_t findSlot(size_t hash) const;
+
+    // Remove the item of the slot, shifting the following items of its probe back.
+    //
+    // Has to hold mutex_ before being called.
+    void eraseSlot(size_t slot);
+
+    // Move the items to a table twice the size, the old one is kept for running lookups.
+    //
+    // Has to hold mutex_ before being called.
+    void growTable();
+
     // Maximum cache size.
     std::atomic<size_t> m_capacity;
 
-    // Current total size of the cache.
+    // Current total charge of the cache.
     std::atomic<size_t> m_usage;
 
-    // Guards m_list, m_head, and m_recycle. In addition, updating m_table also has
+    StripedCounter m_hits;
+    StripedCounter m_misses;
+    std::atomic<uint64_t> m_evictions = {0};
+
+    // Guards m_list, m_head, m_recycle and m_tables. In addition, updating m_table also has
     // to hold the mutex, to avoid the cache being in inconsistent state.
     std::mutex m_mutex;
 
-    // Hash table (tbb::concurrent_hash_map) for lookup.
-    HashTable m_table;
+    // The current table for lookup, and the number of items in it.
+    std::atomic<Table*> m_table = {nullptr};
+    size_t m_tableItems = 0;
+
+    // All the tables ever used, the retired ones may still be read by lookups.
+    std::vector<std::unique_ptr<Table>> m_tables;
 
     Deleter m_deleter;
+    KeyEqual m_keyEqual;
+    Deleter m_keyDeleter;
 };
 
 template <typename T>
@@ -182,18 +322,18 @@ public:
         m_ownedShard = ownedShard;
     }
 
+    // A handle of a value which could not be cached, it owns the value.
+    explicit CacheHandle(std::unique_ptr<T> value) : m_uncached(std::move(value)) {}
+
     CacheHandle(const CacheHandle&) = delete;
 
     CacheHandle& operator=(const CacheHandle&) = delete;
 
     CacheHandle(CacheHandle&& a)
     {
-        if (isValid())
-        {
-            m_ownedShard->unref(m_item, true);
-        }
         m_item = a.m_item;
         m_ownedShard = a.m_ownedShard;
+        m_uncached = std::move(a.m_uncached);
         a.m_item = nullptr;
         a.m_ownedShard = nullptr;
     }
@@ -202,12 +342,13 @@ public:
     {
         if (this != &a)
         {
-            if (isValid())
+            if (isCached())
             {
                 m_ownedShard->unref(m_item, true);
             }
             m_item = a.m_item;
             m_ownedShard = a.m_ownedShard;
+            m_uncached = std::move(a.m_uncached);
             a.m_item = nullptr;
             a.m_ownedShard = nullptr;
         }
@@ -216,17 +357,18 @@ public:
 
     ~CacheHandle()
     {
-        if (isValid())
+        if (isCached())
         {
             m_ownedShard->unref(m_item, true);
         }
     }
 
-    T& value() const { return *static_cast<T*>(m_item->value); }
+    T& value() const { return m_uncached ? *m_uncached : *static_cast<T*>(m_item->value); }
 
     bool release()
     {
-        if (isValid())
+        m_uncached.reset();
+        if (isCached())
         {
             auto result = m_ownedShard->unref(m_item, true);
             m_item = nullptr;
@@ -236,13 +378,18 @@ public:
         return false;
     }
 
-    bool isValid() const { return m_item != nullptr && m_ownedShard != nullptr; }
+    bool isValid() const { return isCached() || m_uncached; }
 
 private:
-    CacheItem* m_item;
-    CacheShard* m_ownedShard;
+    bool isCached() const { return m_item != nullptr && m_ownedShard != nullptr; }
+
+    CacheItem* m_item = nullptr;
+    CacheShard* m_ownedShard = nullptr;
+    std::unique_ptr<T> m_uncached;
 };
 
+// The capacity is the total charge of all the shards, each shard holds an equal part of it. An
+// entry inserted without a charge costs 1, so that the capacity is the number of entries.
 template <typename K, typename V>
 class ClockCache
 {
@@ -258,10 +405,16 @@ public:
         m_shardMask = (size_t{1} << numShardBits) - 1;
         m_shards = new CacheShard[m_numShards];
 
+        auto shardCapacity = (capacity + m_numShards - 1) / m_numShards;
         for (auto i = 0u; i < m_numShards; ++i)
         {
-            m_shards[i].setCapacity(capacity);
+            m_shards[i].setCapacity(shardCapacity);
             m_shards[i].setDeleter([](void* value) { delete static_cast<V*>(value); });
+            m_shards[i].setKeyFunctions(
+                [](const void* key, const void* other) {
+                    return *static_cast<const K*>(key) == *static_cast<const K*>(other);
+                },
+                [](void* key) { delete static_cast<K*>(key); });
         }
     }
 
@@ -270,16 +423,27 @@ public:
         auto hasher = boost::hash<K>();
         auto hash = hasher(key);
         auto& ownedShard = getShard(hash);
-        auto item = ownedShard.lookup(hash);
+        auto item = ownedShard.lookup(hash, &key);
         return CacheHandle<V>(item, &ownedShard);
     }
 
     bool insert(const K& key, V* value, CacheHandle<V>* outHandle = nullptr)
+    {
+        return insert(key, value, 1, outHandle);
+    }
+
+    // The cache takes the ownership of value only if it is inserted.
+    bool insert(const K& key, V* value, size_t charge, CacheHandle<V>* outHandle = nullptr)
     {
         auto hasher = boost::hash<K>();
         auto hash = hasher(key);
         auto& shard = getShard(hash);
-        auto item = shard.insert(hash, value, outHandle != nullptr);
+        auto ownedKey = new K(key);
+        auto item = shard.insert(hash, ownedKey, value, charge, outHandle != nullptr);
+        if (item == nullptr)
+        {
+            delete ownedKey;
+        }
         if (outHandle != nullptr)
         {
             if (item != nullptr)
@@ -290,9 +454,87 @@ public:
         return item != nullptr;
     }
 
+    // Look up key, or load it by loader on a miss and cache it. loader returns a
+    // std::unique_ptr<V>, a null one if key can not be loaded, then the returned handle is
+    // invalid and nothing is cached. charge(const V&) returns the charge of a loaded value.
+    // Concurrent misses of the same key load it once, the other threads wait for the load.
+    // A call counts one hit if the value is cached, one miss otherwise.
+    template <typename Loader, typename Charge>
+    CacheHandle<V> getOrLoad(const K& key, Loader&& loader, Charge&& charge)
+    {
+        auto hash = boost::hash<K>()(key);
+        auto& shard = getShard(hash);
+        CacheHandle<V> handle(shard.lookup(hash, &key), &shard);
+        if (handle.isValid())
+        {
+            return handle;
+        }
+        auto loaded = m_loads.run(key, [&]() {
+            // a load of key may have finished between the lookup and this one
+            handle = CacheHandle<V>(shard.find(hash, &key), &shard);
+            if (!handle.isValid())
+            {
+                handle = loadAndInsert(key, loader, charge);
+            }
+        });
+        if (!loaded)
+        {
+            handle = CacheHandle<V>(shard.find(hash, &key), &shard);
+            if (!handle.isValid())
+            {
+                // the other load failed or could not cache the value
+                handle = loadAndInsert(key, loader, charge);
+            }
+        }
+        return handle;
+    }
+
+    template <typename Loader>
+    CacheHandle<V> getOrLoad(const K& key, Loader&& loader)
+    {
+        return getOrLoad(key, std::forward<Loader>(loader), [](const V&) { return size_t(1); });
+    }
+
+    // Erase all the entries, the values still referenced by handles are freed with their last
+    // handle
+    void clear()
+    {
+        for (auto i = 0u; i < m_numShards; ++i)
+        {
+            m_shards[i].eraseAll();
+        }
+    }
+
+    CacheStats stats() const
+    {
+        CacheStats stats;
+        for (auto i = 0u; i < m_numShards; ++i)
+        {
+            stats += m_shards[i].stats();
+        }
+        return stats;
+    }
+
     ~ClockCache() { delete[] m_shards; }
 
 private:
+    template <typename Loader, typename Charge>
+    CacheHandle<V> loadAndInsert(const K& key, Loader& loader, Charge& charge)
+    {
+        std::unique_ptr<V> value = loader();
+        if (!value)
+        {
+            return CacheHandle<V>();
+        }
+        CacheHandle<V> handle;
+        if (insert(key, value.get(), charge(*value), &handle))
+        {
+            std::ignore = value.release();
+            return handle;
+        }
+        return CacheHandle<V>(std::move(value));
+    }
+
     CacheShard& getShard(size_t hash)
     {
         auto shardId = hash & m_shardMask;
@@ -302,6 +544,7 @@ private:
     size_t m_numShards;
     size_t m_shardMask;
     CacheShard* m_shards;
+    SingleFlight<K, boost::hash<K>> m_loads;
 };
 }  // namespace executor
 }  // namespace bcos
\ No newline at end of file
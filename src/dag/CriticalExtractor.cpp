@@ -0,0 +1,199 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : critical keys read from the Solidity ABI encoded params in place
+ * @file CriticalExtractor.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-14
+ */
+
+#include "CriticalExtractor.h"
+#include <cstring>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+namespace
+{
+constexpr size_t c_wordSize = 32;
+
+// N of uintN/intN/bytesN after _prefix, 0 if it is not a number
+size_t parseSize(const std::string& _type, size_t _prefix)
+{
+    if (_type.size() == _prefix || _type.size() > _prefix + 3)
+    {
+        return 0;
+    }
+    size_t size = 0;
+    for (auto i = _prefix; i < _type.size(); ++i)
+    {
+        if (_type[i] < '0' || _type[i] > '9')
+        {
+            return 0;
+        }
+        size = size * 10 + (_type[i] - '0');
+    }
+    return size;
+}
+
+// an offset or length word, false if it doesn't fit in 64 bits
+bool readLength(const uint8_t* _word, uint64_t& _length)
+{
+    for (size_t i = 0; i < c_wordSize - sizeof(uint64_t); ++i)
+    {
+        if (_word[i] != 0)
+        {
+            return false;
+        }
+    }
+    _length = 0;
+    for (auto i = c_wordSize - sizeof(uint64_t); i < c_wordSize; ++i)
+    {
+        _length = (_length << 8) | _word[i];
+    }
+    return true;
+}
+}  // namespace
+
+std::optional<CriticalExtractor::Param> CriticalExtractor::compileType(const std::string& _type)
+{
+    if (_type == "string" || _type == "bytes")
+    {
+        return Param{Kind::Dynamic, 0};
+    }
+    if (_type == "address")
+    {
+        return Param{Kind::Address, 20};
+    }
+    if (_type == "bool")
+    {
+        return Param{Kind::Bool, 1};
+    }
+    if (_type == "uint" || _type == "int")
+    {
+        return Param{_type == "uint" ? Kind::Unsigned : Kind::Signed, 32};
+    }
+
+    auto intType = [&_type](size_t _prefix, Kind _kind) -> std::optional<Param> {
+        auto bits = parseSize(_type, _prefix);
+        if (bits == 0 || bits > 256 || bits % 8 != 0)
+        {
+            return std::nullopt;
+        }
+        return Param{_kind, (uint8_t)(bits / 8)};
+    };
+    if (_type.compare(0, 4, "uint") == 0)
+    {
+        return intType(4, Kind::Unsigned);
+    }
+    if (_type.compare(0, 3, "int") == 0)
+    {
+        return intType(3, Kind::Signed);
+    }
+    if (_type.compare(0, 5, "bytes") == 0)
+    {
+        auto size = parseSize(_type, 5);
+        if (size == 0 || size > c_wordSize)
+        {
+            return std::nullopt;
+        }
+        return Param{Kind::FixedBytes, (uint8_t)size};
+    }
+    return std::nullopt;
+}
+
+std::optional<CriticalExtractor> CriticalExtractor::compile(const std::vector<std::string>& _types)
+{
+    CriticalExtractor extractor;
+    extractor.m_params.reserve(_types.size());
+    for (auto& type : _types)
+    {
+        auto param = compileType(type);
+        if (!param)
+        {
+            return std::nullopt;
+        }
+        extractor.m_params.push_back(*param);
+    }
+    return extractor;
+}
+
+bool CriticalExtractor::extract(
+    bytesConstRef _params, const CriticalKey& _seed, std::vector<CriticalKey>& _keys) const
+{
+    auto data = _params.data();
+    auto size = _params.size();
+    if (size < m_params.size() * c_wordSize)
+    {
+        return false;
+    }
+
+    auto keysSize = _keys.size();
+    uint8_t word[c_wordSize];
+    for (size_t i = 0; i < m_params.size(); ++i)
+    {
+        auto head = data + i * c_wordSize;
+        auto& param = m_params[i];
+        if (param.kind == Kind::Dynamic)
+        {
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            if (!readLength(head, offset) || offset > size || size - offset < c_wordSize ||
+                !readLength(data + offset, length) || length > size - offset - c_wordSize)
+            {
+                _keys.resize(keysSize);
+                return false;
+            }
+            _keys.push_back(CriticalKey::hash(
+                std::string_view((const char*)data + offset + c_wordSize, length), _seed));
+            continue;
+        }
+
+        // the value is right aligned in the word, except bytesN
+        memcpy(word, head, c_wordSize);
+        auto padding = c_wordSize - param.size;
+        switch (param.kind)
+        {
+        case Kind::Unsigned:
+        case Kind::Address:
+            memset(word, 0, padding);
+            break;
+        case Kind::Signed:
+            memset(word, (word[padding] & 0x80) ? 0xff : 0, padding);
+            break;
+        case Kind::Bool:
+        {
+            bool value = false;
+            for (auto byte : word)
+            {
+                value = value || byte != 0;
+            }
+            memset(word, 0, c_wordSize);
+            word[c_wordSize - 1] = value;
+            break;
+        }
+        case Kind::FixedBytes:
+            memset(word + param.size, 0, padding);
+            break;
+        default:
+            break;
+        }
+        _keys.push_back(
+            CriticalKey::hash(std::string_view((const char*)word, c_wordSize), _seed));
+    }
+    return true;
+}
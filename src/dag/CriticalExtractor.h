@@ -0,0 +1,73 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : critical keys read from the Solidity ABI encoded params in place
+ * @file CriticalExtractor.h
+ * @author: xingqiangbai
+ * @date: 2021-12-14
+ */
+
+#pragma once
+#include "DAG.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bcos
+{
+namespace executor
+{
+// The critical params of a function compiled into the kinds of their head words, so that the
+// critical keys of a call are hashed from its calldata without decoding. A static param is keyed
+// on its word with the bits beyond its type cleared as the contract does, a string or bytes on
+// its content.
+class CriticalExtractor
+{
+public:
+    enum class Kind : uint8_t
+    {
+        Unsigned,
+        Signed,
+        Address,
+        Bool,
+        FixedBytes,
+        Dynamic,
+    };
+
+    struct Param
+    {
+        Kind kind;
+        // bytes of the value in the word, 0 for Dynamic
+        uint8_t size;
+    };
+
+    // nullopt if a type is not supported, e.g. arrays and tuples
+    static std::optional<CriticalExtractor> compile(const std::vector<std::string>& _types);
+    static std::optional<Param> compileType(const std::string& _type);
+
+    // Append the keys of the params in _params(the calldata after the selector) to _keys in the
+    // scope of _seed, return false and append nothing if _params is malformed
+    bool extract(bytesConstRef _params, const CriticalKey& _seed,
+        std::vector<CriticalKey>& _keys) const;
+
+    const std::vector<Param>& params() const { return m_params; }
+
+private:
+    std::vector<Param> m_params;
+};
+}  // namespace executor
+}  // namespace bcos
@@ -20,48 +20,243 @@
  */
 
 #include "DAG.h"
+#include <algorithm>
+#include <cstring>
 using namespace std;
 using namespace bcos;
 using namespace bcos::executor;
 
+namespace
+{
+inline uint64_t rotl64(uint64_t _x, int _r)
+{
+    return (_x << _r) | (_x >> (64 - _r));
+}
+
+inline uint64_t fmix64(uint64_t _k)
+{
+    _k ^= _k >> 33;
+    _k *= 0xff51afd7ed558ccdULL;
+    _k ^= _k >> 33;
+    _k *= 0xc4ceb9fe1a85ec53ULL;
+    _k ^= _k >> 33;
+    return _k;
+}
+
+inline uint64_t readBlock(const uint8_t* _data)
+{
+    uint64_t block;
+    memcpy(&block, _data, sizeof(block));
+    return block;
+}
+}  // namespace
+
+CriticalKey CriticalKey::hash(std::string_view _field)
+{
+    return hash(_field, CriticalKey());
+}
+
+CriticalKey CriticalKey::hash(std::string_view _field, const CriticalKey& _seed)
+{
+    // MurmurHash3_x64_128, seeded by the two halves of _seed
+    auto data = reinterpret_cast<const uint8_t*>(_field.data());
+    auto len = _field.size();
+    auto nblocks = len / 16;
+    uint64_t h1 = _seed.low;
+    uint64_t h2 = _seed.high;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        auto k1 = readBlock(data + i * 16);
+        auto k2 = readBlock(data + i * 16 + 8);
+
+        k1 *= c1;
+        k1 = rotl64(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = rotl64(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = rotl64(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = rotl64(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    auto tail = data + nblocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (len & 15)
+    {
+    case 15:
+        k2 ^= ((uint64_t)tail[14]) << 48;
+        [[fallthrough]];
+    case 14:
+        k2 ^= ((uint64_t)tail[13]) << 40;
+        [[fallthrough]];
+    case 13:
+        k2 ^= ((uint64_t)tail[12]) << 32;
+        [[fallthrough]];
+    case 12:
+        k2 ^= ((uint64_t)tail[11]) << 24;
+        [[fallthrough]];
+    case 11:
+        k2 ^= ((uint64_t)tail[10]) << 16;
+        [[fallthrough]];
+    case 10:
+        k2 ^= ((uint64_t)tail[9]) << 8;
+        [[fallthrough]];
+    case 9:
+        k2 ^= ((uint64_t)tail[8]);
+        k2 *= c2;
+        k2 = rotl64(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        [[fallthrough]];
+    case 8:
+        k1 ^= ((uint64_t)tail[7]) << 56;
+        [[fallthrough]];
+    case 7:
+        k1 ^= ((uint64_t)tail[6]) << 48;
+        [[fallthrough]];
+    case 6:
+        k1 ^= ((uint64_t)tail[5]) << 40;
+        [[fallthrough]];
+    case 5:
+        k1 ^= ((uint64_t)tail[4]) << 32;
+        [[fallthrough]];
+    case 4:
+        k1 ^= ((uint64_t)tail[3]) << 24;
+        [[fallthrough]];
+    case 3:
+        k1 ^= ((uint64_t)tail[2]) << 16;
+        [[fallthrough]];
+    case 2:
+        k1 ^= ((uint64_t)tail[1]) << 8;
+        [[fallthrough]];
+    case 1:
+        k1 ^= ((uint64_t)tail[0]);
+        k1 *= c1;
+        k1 = rotl64(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    };
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return CriticalKey{h1, h2};
+}
+
+void CSRGraph::init(ID _maxSize, size_t _edgeHint)
+{
+    clear();
+    m_size = _maxSize;
+    m_pendingEdges.reserve(_edgeHint);
+}
+
+void CSRGraph::addEdge(ID _f, ID _t)
+{
+    if (_f >= m_size || _t >= m_size)
+        return;
+    m_pendingEdges.emplace_back(_f, _t);
+}
+
+void CSRGraph::addEdges(std::vector<DAGEdge>&& _edges)
+{
+    auto outOfRange = [this](const DAGEdge& _edge) {
+        return _edge.first >= m_size || _edge.second >= m_size;
+    };
+    _edges.erase(std::remove_if(_edges.begin(), _edges.end(), outOfRange), _edges.end());
+    if (m_pendingEdges.empty())
+    {
+        m_pendingEdges = std::move(_edges);
+    }
+    else
+    {
+        m_pendingEdges.insert(m_pendingEdges.end(), _edges.begin(), _edges.end());
+    }
+}
+
+void CSRGraph::build()
+{
+    // Counting sort by source vertex, the out edges of a vertex keep their insertion order
+    m_offsets.assign((size_t)m_size + 1, 0);
+    m_inDegrees.reset(new InDegree[m_size]);
+    for (auto& edge : m_pendingEdges)
+    {
+        ++m_offsets[edge.first + 1];
+        m_inDegrees[edge.second].value.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (ID id = 0; id < m_size; ++id)
+    {
+        m_offsets[id + 1] += m_offsets[id];
+    }
+
+    m_edges.resize(m_pendingEdges.size());
+    std::vector<ID> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    for (auto& edge : m_pendingEdges)
+    {
+        m_edges[cursor[edge.first]++] = edge.second;
+    }
+    m_pendingEdges = std::vector<DAGEdge>();
+}
+
+void CSRGraph::clear()
+{
+    m_size = 0;
+    m_pendingEdges = std::vector<DAGEdge>();
+    m_offsets = std::vector<ID>();
+    m_edges = std::vector<ID>();
+    m_inDegrees.reset();
+}
+
 DAG::~DAG()
 {
     clear();
 }
 
-void DAG::init(ID _maxSize)
+void DAG::init(ID _maxSize, size_t _edgeHint)
 {
     clear();
-    for (ID i = 0; i < _maxSize; ++i)
-        m_vtxs.emplace_back(make_shared<Vertex>());
+    m_graph.init(_maxSize, _edgeHint);
     m_totalVtxs = _maxSize;
     m_totalConsume = 0;
 }
 
 void DAG::addEdge(ID _f, ID _t)
 {
-    if (_f >= m_vtxs.size() && _t >= m_vtxs.size())
-        return;
-    m_vtxs[_f]->outEdge.emplace_back(_t);
-    m_vtxs[_t]->inDegree += 1;
+    m_graph.addEdge(_f, _t);
     // PARA_LOG(TRACE) << LOG_BADGE("DAG") << LOG_DESC("Add edge") << LOG_KV("from", _f)
     //                << LOG_KV("to", _t);
 }
 
 void DAG::generate()
 {
-    for (ID id = 0; id < m_vtxs.size(); ++id)
+    m_graph.build();
+    for (ID id = 0; id < m_graph.size(); ++id)
     {
-        if (m_vtxs[id]->inDegree == 0)
+        if (m_graph.inDegree(id) == 0)
             m_topLevel.push(id);
     }
 
     // PARA_LOG(TRACE) << LOG_BADGE("DAG") << LOG_DESC("generate")
     //                << LOG_KV("queueSize", m_topLevel.size());
-    // for (ID id = 0; id < m_vtxs.size(); id++)
+    // for (ID id = 0; id < m_graph.size(); id++)
     // printVtx(id);
 }
-
 ID DAG::waitPop(bool _needWait)
 {
     // Note: concurrent_queue of TBB can't be used with boost::conditional_variable
@@ -100,12 +295,10 @@ ID DAG::consume(ID _id)
     ID producedNum = 0;
     ID nextId = INVALID_ID;
     ID lastDegree = INVALID_ID;
-    for (ID id : m_vtxs[_id]->outEdge)
+    for (auto it = m_graph.outEdgesBegin(_id); it != m_graph.outEdgesEnd(_id); ++it)
     {
-        auto vtx = m_vtxs[id];
-        {
-            lastDegree = vtx->inDegree.fetch_sub(1);
-        }
+        ID id = *it;
+        lastDegree = m_graph.inDegree(id).fetch_sub(1);
         if (lastDegree == 1)
         {
             ++producedNum;
@@ -127,22 +320,22 @@ ID DAG::consume(ID _id)
     }
     // PARA_LOG(TRACE) << LOG_BADGE("TbbCqDAG") << LOG_DESC("consumed")
     //                << LOG_KV("queueSize", m_topLevel.size());
-    // for (ID id = 0; id < m_vtxs.size(); id++)
+    // for (ID id = 0; id < m_graph.size(); id++)
     // printVtx(id);
     return nextId;
 }
 
 void DAG::clear()
 {
-    m_vtxs = std::vector<std::shared_ptr<Vertex>>();
+    m_graph.clear();
     // XXXX m_topLevel.clear();
 }
 
 void DAG::printVtx(ID _id)
 {
-    for (ID id : m_vtxs[_id]->outEdge)
+    for (auto it = m_graph.outEdgesBegin(_id); it != m_graph.outEdgesEnd(_id); ++it)
     {
         PARA_LOG(TRACE) << LOG_BADGE("DAG") << LOG_DESC("VertexEdge") << LOG_KV("ID", _id)
-                        << LOG_KV("inDegree", m_vtxs[_id]->inDegree) << LOG_KV("edge", id);
+                        << LOG_KV("inDegree", m_graph.inDegree(_id)) << LOG_KV("edge", *it);
     }
 }
\ No newline at end of file
@@ -26,7 +26,9 @@
 #include <tbb/concurrent_queue.h>
 #include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <queue>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -37,11 +39,73 @@ namespace executor
 using ID = uint32_t;
 using IDs = std::vector<ID>;
 static const ID INVALID_ID = (ID(0) - 1);
+// Edge from first to second
+using DAGEdge = std::pair<ID, ID>;
 
-struct Vertex
+// 128-bit hash (MurmurHash3 x64_128) of a critical field, the DAG is built on the keys instead of
+// the fields, so that no string is compared or copied
+struct CriticalKey
 {
-    std::atomic<ID> inDegree;
-    std::vector<ID> outEdge;
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    static CriticalKey hash(std::string_view _field);
+    // hash of _field in the scope of _seed, e.g. of a contract, without concatenating them
+    static CriticalKey hash(std::string_view _field, const CriticalKey& _seed);
+
+    bool operator==(const CriticalKey& _other) const
+    {
+        return low == _other.low && high == _other.high;
+    }
+    bool operator!=(const CriticalKey& _other) const { return !(*this == _other); }
+};
+
+struct CriticalKeyHash
+{
+    size_t operator()(const CriticalKey& _key) const { return _key.low; }
+};
+
+// In-degree counter padded to a cache line, so that workers decreasing the in-degree of
+// neighbouring vertexes do not invalidate each other's cache line
+struct alignas(64) InDegree
+{
+    std::atomic<ID> value = {0};
+};
+
+// Vertexes and edges in compressed sparse row form. Edges added by addEdge() are buffered and
+// laid out into one offsets array and one edges array by build(), the out edges of vertex v are
+// edges[offsets[v], offsets[v + 1]). Just algorithm, not thread safe, except inDegree().
+class CSRGraph
+{
+public:
+    // _maxSize is max ID + 1, _edgeHint is the expected number of edges
+    void init(ID _maxSize, size_t _edgeHint = 0);
+
+    // Buffer an edge, edges out of range are ignored
+    void addEdge(ID _f, ID _t);
+
+    // Buffer edges in bulk, edges out of range are ignored
+    void addEdges(std::vector<DAGEdge>&& _edges);
+
+    // Lay out the buffered edges, must be called before outEdges()/inDegree()
+    void build();
+
+    void clear();
+
+    ID size() const { return m_size; }
+    size_t edgeNum() const { return m_edges.size(); }
+
+    const ID* outEdgesBegin(ID _id) const { return m_edges.data() + m_offsets[_id]; }
+    const ID* outEdgesEnd(ID _id) const { return m_edges.data() + m_offsets[_id + 1]; }
+
+    std::atomic<ID>& inDegree(ID _id) { return m_inDegrees[_id].value; }
+
+private:
+    ID m_size = 0;
+    std::vector<DAGEdge> m_pendingEdges;
+    std::vector<ID> m_offsets;
+    std::vector<ID> m_edges;
+    std::unique_ptr<InDegree[]> m_inDegrees;
 };
 
 class DAG
@@ -52,13 +116,14 @@ public:
     ~DAG();
 
     // Init DAG basic memory, should call before other function
-    // _maxSize is max ID + 1
-    void init(ID _maxSize);
+    // _maxSize is max ID + 1, _edgeHint is the expected number of edges
+    void init(ID _maxSize, size_t _edgeHint = 0);
 
     // Add edge between vertex
     void addEdge(ID _f, ID _t);
+    void addEdges(std::vector<DAGEdge>&& _edges) { m_graph.addEdges(std::move(_edges)); }
 
-    // Generate DAG
+    // Generate DAG, build the vertex storage from the added edges
     void generate();
 
     // Wait until topLevel is not empty, return INVALID_ID if DAG reach the end
@@ -70,8 +135,10 @@ public:
     // Clear all data of this class (thread safe)
     void clear();
 
+    size_t edgeNum() const { return m_graph.edgeNum(); }
+
 private:
-    std::vector<std::shared_ptr<Vertex>> m_vtxs;
+    CSRGraph m_graph;
     tbb::concurrent_queue<ID> m_topLevel;
 
     ID m_totalVtxs = 0;
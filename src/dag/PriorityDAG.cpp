@@ -0,0 +1,176 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : DAG scheduler which runs the vertex with the longest remaining critical path first
+ * @file PriorityDAG.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-08
+ */
+
+#include "PriorityDAG.h"
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+namespace
+{
+// Rounds of polling before an idle worker parks itself
+const int c_spinRounds = 64;
+}  // namespace
+
+PriorityDAG::~PriorityDAG()
+{
+    clear();
+}
+
+void PriorityDAG::init(ID _maxSize, size_t _edgeHint)
+{
+    clear();
+    m_graph.init(_maxSize, _edgeHint);
+    m_totalVtxs = _maxSize;
+    m_totalConsume = 0;
+    m_stop = false;
+}
+
+void PriorityDAG::addEdge(ID _f, ID _t)
+{
+    assert(_f < _t);
+    m_graph.addEdge(_f, _t);
+}
+
+void PriorityDAG::generate()
+{
+    m_graph.build();
+
+    // Every edge goes to a higher ID, so the children of a vertex are ranked before it
+    auto size = m_graph.size();
+    m_ranks.assign(size, 0);
+    for (ID id = size; id > 0; --id)
+    {
+        auto vertex = id - 1;
+        uint64_t childRank = 0;
+        for (auto it = m_graph.outEdgesBegin(vertex); it != m_graph.outEdgesEnd(vertex); ++it)
+        {
+            childRank = std::max(childRank, m_ranks[*it]);
+        }
+        auto weight = vertex < m_weights.size() ? m_weights[vertex] : 1;
+        m_ranks[vertex] = childRank + weight;
+    }
+
+    for (ID id = 0; id < size; ++id)
+    {
+        if (m_graph.inDegree(id).load(memory_order_relaxed) == 0)
+        {
+            m_ready.push({m_ranks[id], id});
+        }
+    }
+}
+
+ID PriorityDAG::waitPop(bool _needWait)
+{
+    ReadyVertex vertex;
+    while (true)
+    {
+        for (int round = 0; round < c_spinRounds; ++round)
+        {
+            if (m_ready.try_pop(vertex))
+            {
+                return vertex.id;
+            }
+            if (finished() || !_needWait)
+            {
+                return INVALID_ID;
+            }
+            std::this_thread::yield();
+        }
+
+        auto key = m_idle.prepareWait();
+        if (m_ready.try_pop(vertex))
+        {
+            m_idle.cancelWait();
+            return vertex.id;
+        }
+        if (finished())
+        {
+            m_idle.cancelWait();
+            return INVALID_ID;
+        }
+        m_idle.commitWait(key);
+    }
+}
+
+ID PriorityDAG::consume(ID _id)
+{
+    ID producedNum = 0;
+    ID nextId = INVALID_ID;
+    for (auto it = m_graph.outEdgesBegin(_id); it != m_graph.outEdgesEnd(_id); ++it)
+    {
+        ID id = *it;
+        if (m_graph.inDegree(id).fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            ++producedNum;
+            if (producedNum == 1)
+            {
+                nextId = id;
+            }
+            else
+            {
+                // keep the child with the highest rank for this worker
+                if (m_ranks[id] > m_ranks[nextId])
+                {
+                    std::swap(id, nextId);
+                }
+                m_ready.push({m_ranks[id], id});
+            }
+        }
+    }
+
+    if (nextId != INVALID_ID && !m_ready.empty())
+    {
+        // a vertex readied by another worker may rank higher, let the queue decide
+        m_ready.push({m_ranks[nextId], nextId});
+        ReadyVertex vertex;
+        nextId = m_ready.try_pop(vertex) ? vertex.id : INVALID_ID;
+    }
+    if (producedNum > 1)
+    {
+        m_idle.notify(producedNum - 1);
+    }
+
+    if (m_totalConsume.fetch_add(1, memory_order_acq_rel) + 1 == m_totalVtxs)
+    {
+        m_idle.notifyAll();
+    }
+    return nextId;
+}
+
+void PriorityDAG::stop()
+{
+    m_stop.store(true);
+    m_idle.notifyAll();
+}
+
+void PriorityDAG::clear()
+{
+    m_graph.clear();
+    m_weights.clear();
+    m_ranks.clear();
+    m_ready.clear();
+}
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : DAG scheduler which runs the vertex with the longest remaining critical path first
+ * @file PriorityDAG.h
+ * @author: xingqiangbai
+ * @date: 2021-12-08
+ */
+
+#pragma once
+#include "DAG.h"
+#include "WorkStealingDAG.h"
+#include <tbb/concurrent_priority_queue.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace bcos
+{
+namespace executor
+{
+class PriorityDAG
+{
+public:
+    PriorityDAG() = default;
+    ~PriorityDAG();
+
+    // Init DAG basic memory, should call before other function
+    // _maxSize is max ID + 1, _edgeHint is the expected number of edges
+    void init(ID _maxSize, size_t _edgeHint = 0);
+
+    // Cost estimate of every vertex, e.g. the size of calldata, call after init(), every vertex
+    // costs 1 if not set
+    void setWeights(std::vector<uint64_t> _weights) { m_weights = std::move(_weights); }
+
+    // Add edge between vertex, edges must go from a lower ID to a higher one, which always holds
+    // for transactions
+    void addEdge(ID _f, ID _t);
+    void addEdges(std::vector<DAGEdge>&& _edges) { m_graph.addEdges(std::move(_edges)); }
+
+    // Generate DAG, compute the remaining critical path length of every vertex
+    void generate();
+
+    // Pop the ready vertex with the highest priority, park the worker if nothing is ready, return
+    // INVALID_ID if DAG reach the end or stopped
+    ID waitPop(bool _needWait = true);
+
+    // Consume the vertex and make its children ready, return the ready vertex with the highest
+    // priority (thread safe)
+    ID consume(ID _id);
+
+    // Wake up all parked workers and make waitPop return INVALID_ID
+    void stop();
+
+    void clear();
+
+    // Weighted length of the longest path starting from the vertex, itself included
+    uint64_t rank(ID _id) const { return m_ranks[_id]; }
+
+private:
+    // Higher rank first, lower ID first for the same rank
+    struct ReadyVertex
+    {
+        uint64_t rank;
+        ID id;
+        bool operator<(const ReadyVertex& _other) const
+        {
+            return rank < _other.rank || (rank == _other.rank && id > _other.id);
+        }
+    };
+
+    bool finished() const
+    {
+        return m_totalConsume.load(std::memory_order_acquire) >= m_totalVtxs || m_stop.load();
+    }
+
+    CSRGraph m_graph;
+    std::vector<uint64_t> m_weights;
+    std::vector<uint64_t> m_ranks;
+    tbb::concurrent_priority_queue<ReadyVertex> m_ready;
+    EventCount m_idle;
+
+    ID m_totalVtxs = 0;
+    std::atomic<ID> m_totalConsume = {0};
+    std::atomic_bool m_stop = {false};
+};
+
+}  // namespace executor
+}  // namespace bcos
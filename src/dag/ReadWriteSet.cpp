@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : storage rows read and written by speculatively executed transactions
+ * @file ReadWriteSet.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-10
+ */
+
+#include "ReadWriteSet.h"
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+CriticalKey bcos::executor::rowKey(std::string_view _table, std::string_view _key)
+{
+    auto table = CriticalKey::hash(_table);
+    auto key = CriticalKey::hash(_key);
+    // asymmetric mix, so that (a, b) and (b, a) differ
+    return {key.low ^ (table.low * 0x9e3779b97f4a7c15ULL), key.high ^ (table.high + 1)};
+}
+
+void ReadSet::clear()
+{
+    m_rows.clear();
+    m_tables.clear();
+    m_untracked = false;
+}
+
+void WriteSet::write(std::string_view _table, std::string_view _key)
+{
+    m_rows.insert(rowKey(_table, _key));
+    m_tables.insert(CriticalKey::hash(_table));
+}
+
+bool WriteSet::conflicts(const ReadSet& _readSet) const
+{
+    if (_readSet.untracked())
+    {
+        return true;
+    }
+    if (m_rows.empty())
+    {
+        return false;
+    }
+    for (auto& row : _readSet.rows())
+    {
+        if (m_rows.count(row))
+        {
+            return true;
+        }
+    }
+    for (auto& table : _readSet.tables())
+    {
+        if (m_tables.count(table))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WriteSet::clear()
+{
+    m_rows.clear();
+    m_tables.clear();
+}
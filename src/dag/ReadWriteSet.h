@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : storage rows read and written by speculatively executed transactions
+ * @file ReadWriteSet.h
+ * @author: xingqiangbai
+ * @date: 2021-12-10
+ */
+
+#pragma once
+#include "DAG.h"
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace bcos
+{
+namespace executor
+{
+// Key of a storage row, the table and the key are hashed apart so that nothing is concatenated
+CriticalKey rowKey(std::string_view _table, std::string_view _key);
+
+// Rows read by one speculatively executed transaction. Reads of a whole table, e.g. listing its
+// primary keys, are kept apart. Accesses which can't be tracked, e.g. through a Table handle, mark
+// the set untracked, and such a transaction is never trusted by the validation.
+class ReadSet
+{
+public:
+    using Ptr = std::shared_ptr<ReadSet>;
+
+    void read(std::string_view _table, std::string_view _key)
+    {
+        m_rows.push_back(rowKey(_table, _key));
+    }
+    void readTable(std::string_view _table) { m_tables.push_back(CriticalKey::hash(_table)); }
+    void setUntracked() { m_untracked = true; }
+
+    const std::vector<CriticalKey>& rows() const { return m_rows; }
+    const std::vector<CriticalKey>& tables() const { return m_tables; }
+    bool untracked() const { return m_untracked; }
+
+    void clear();
+
+private:
+    std::vector<CriticalKey> m_rows;
+    std::vector<CriticalKey> m_tables;
+    bool m_untracked = false;
+};
+
+// Rows written by the transactions committed so far in block order. A speculative transaction is
+// valid if it read none of them, since it was executed on the state before all of them.
+class WriteSet
+{
+public:
+    void write(std::string_view _table, std::string_view _key);
+
+    bool conflicts(const ReadSet& _readSet) const;
+
+    size_t size() const { return m_rows.size(); }
+    void clear();
+
+private:
+    std::unordered_set<CriticalKey, CriticalKeyHash> m_rows;
+    std::unordered_set<CriticalKey, CriticalKeyHash> m_tables;
+};
+
+}  // namespace executor
+}  // namespace bcos
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief at most one load of a key at a time, for the caches
+ * @file SingleFlight.h
+ * @author: xingqiangbai
+ * @date: 2021-12-16
+ */
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace bcos
+{
+namespace executor
+{
+// Runs the load of a key in one thread, the other threads asking for the key meanwhile wait for
+// it instead of loading it again, and then find the result in the cache. Loads of different keys
+// run in parallel.
+template <typename K, typename Hash = std::hash<K>>
+class SingleFlight
+{
+public:
+    // Run _load if no other thread is loading _key, otherwise wait for that load to finish.
+    // Returns true if _load was run by this thread. An exception of _load is thrown to its caller
+    // only, the waiting threads just return false.
+    template <typename Load>
+    bool run(const K& _key, Load&& _load)
+    {
+        std::promise<void> done;
+        std::shared_future<void> loading;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_loadings.find(_key);
+            if (it != m_loadings.end())
+            {
+                loading = it->second;
+            }
+            else
+            {
+                m_loadings.emplace(_key, done.get_future().share());
+            }
+        }
+        if (loading.valid())
+        {
+            loading.wait();
+            return false;
+        }
+
+        try
+        {
+            _load();
+        }
+        catch (...)
+        {
+            finish(_key, done);
+            throw;
+        }
+        finish(_key, done);
+        return true;
+    }
+
+private:
+    void finish(const K& _key, std::promise<void>& _done)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_loadings.erase(_key);
+        }
+        _done.set_value();
+    }
+
+    std::mutex m_mutex;
+    std::unordered_map<K, std::shared_future<void>, Hash> m_loadings;
+};
+}  // namespace executor
+}  // namespace bcos
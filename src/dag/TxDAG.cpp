@@ -21,7 +21,13 @@
 
 #include "TxDAG.h"
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <cassert>
 #include <map>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 
 using namespace std;
 using namespace bcos;
@@ -29,50 +35,382 @@ using namespace bcos::executor;
 
 #define DAG_LOG(LEVEL) BCOS_LOG(LEVEL) << LOG_BADGE("DAG")
 
-// Generate DAG according with given transactions
-void TxDAG::init(size_t count, const std::vector<std::vector<std::string>>& _txsCriticals)
+namespace
 {
-    auto txsSize = count;
-    DAG_LOG(TRACE) << LOG_DESC("Begin init transaction DAG") << LOG_KV("transactionNum", txsSize);
-    m_dag.init(txsSize);
+// Edge found by one shard, position is the index of the field in the criticals of "to"
+struct ShardEdge
+{
+    ID from;
+    ID to;
+    uint32_t position;
+};
 
-    CriticalField<string> latestCriticals;
+// Finds the edges of the keys owned by the shard, in the order of the serial path. An exclusive
+// key depends on its last exclusive accessor and on the shared accessors since then, a shared key
+// only depends on the last exclusive accessor. _emit(from, to, position) is called with the
+// position of the key in the criticals of "to", the shared keys following the exclusive ones.
+template <typename Emit>
+void collectEdges(const CriticalSpans& _criticals, size_t _shard, size_t _shardNum, Emit&& _emit)
+{
+    auto& keys = _criticals.keys;
+    auto& offsets = _criticals.offsets;
+    auto& sharedKeys = _criticals.sharedKeys;
+    auto& sharedOffsets = _criticals.sharedOffsets;
+    bool hasShared = !sharedOffsets.empty();
+    auto owned = [&](const CriticalKey& _key) { return _key.high % _shardNum == _shard; };
 
-    for (ID id = 0; id < txsSize; ++id)
+    CriticalField<CriticalKey> latestCriticals;
+    latestCriticals.reserve(keys.size() / _shardNum + 1);
+    // shared accessors of every key since its last exclusive accessor
+    std::unordered_map<CriticalKey, std::vector<ID>, CriticalKeyHash> sharedAccessors;
+
+    auto count = offsets.size() - 1;
+    for (ID id = 0; id < count; ++id)
     {
-        auto criticals = _txsCriticals[id];
-        if (!criticals.empty())
+        auto begin = offsets[id];
+        auto end = offsets[id + 1];
+        auto sharedBegin = hasShared ? sharedOffsets[id] : 0;
+        auto sharedEnd = hasShared ? sharedOffsets[id + 1] : 0;
+
+        // lookup all fields before updating
+        for (auto k = begin; k < end; ++k)
+        {
+            if (!owned(keys[k]))
+            {
+                continue;
+            }
+            ID pId = latestCriticals.get(keys[k]);
+            if (pId != INVALID_ID)
+            {
+                _emit(pId, id, k - begin);
+            }
+            if (hasShared)
+            {
+                auto it = sharedAccessors.find(keys[k]);
+                if (it != sharedAccessors.end())
+                {
+                    for (auto accessor : it->second)
+                    {
+                        _emit(accessor, id, k - begin);
+                    }
+                }
+            }
+        }
+        for (auto k = sharedBegin; k < sharedEnd; ++k)
         {
-            // DAG transaction: Conflict with certain critical fields
-            // Get critical field
+            if (!owned(sharedKeys[k]))
+            {
+                continue;
+            }
+            ID pId = latestCriticals.get(sharedKeys[k]);
+            if (pId != INVALID_ID)
+            {
+                _emit(pId, id, (end - begin) + (k - sharedBegin));
+            }
+        }
 
-            // Add edge between critical transaction
-            for (string const& c : criticals)
+        // shared first, an exclusive access of the same key by this transaction supersedes it
+        for (auto k = sharedBegin; k < sharedEnd; ++k)
+        {
+            if (owned(sharedKeys[k]))
             {
-                ID pId = latestCriticals.get(c);
-                if (pId != INVALID_ID)
+                auto& accessors = sharedAccessors[sharedKeys[k]];
+                if (accessors.empty() || accessors.back() != id)
                 {
-                    m_dag.addEdge(pId, id);  // add DAG edge
+                    accessors.push_back(id);
                 }
             }
+        }
+        for (auto k = begin; k < end; ++k)
+        {
+            if (owned(keys[k]))
+            {
+                latestCriticals.update(keys[k], id);
+                if (hasShared)
+                {
+                    sharedAccessors.erase(keys[k]);
+                }
+            }
+        }
+    }
+}
+
+std::vector<DAGEdge> serialCriticalEdges(const CriticalSpans& _criticals)
+{
+    std::vector<DAGEdge> edges;
+    edges.reserve(_criticals.keys.size());
+    collectEdges(_criticals, 0, 1, [&](ID _from, ID _to, uint32_t) {
+        edges.emplace_back(_from, _to);  // add DAG edge
+    });
+    return edges;
+}
+
+// Every shard owns the keys with the same remainder and finds the edges of them independently,
+// then the edges of all shards are merged in the order of the serial path
+std::vector<DAGEdge> parallelCriticalEdges(const CriticalSpans& _criticals)
+{
+    size_t shardNum = std::max(std::thread::hardware_concurrency(), 1u) * 4;
+    std::vector<std::vector<ShardEdge>> shardEdges(shardNum);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, shardNum), [&](const auto& range) {
+        for (auto shard = range.begin(); shard < range.end(); ++shard)
+        {
+            auto& edges = shardEdges[shard];
+            collectEdges(_criticals, shard, shardNum,
+                [&](ID _from, ID _to, uint32_t _position) {
+                    edges.push_back({_from, _to, _position});
+                });
+        }
+    });
+
+    std::vector<ShardEdge> merged;
+    size_t total = 0;
+    for (auto& edges : shardEdges)
+    {
+        total += edges.size();
+    }
+    merged.reserve(total);
+    for (auto& edges : shardEdges)
+    {
+        merged.insert(merged.end(), edges.begin(), edges.end());
+        edges = std::vector<ShardEdge>();
+    }
+    // the shared accessors of a key are emitted in ascending order after its exclusive one
+    tbb::parallel_sort(
+        merged.begin(), merged.end(), [](const ShardEdge& lhs, const ShardEdge& rhs) {
+            return std::tie(lhs.to, lhs.position, lhs.from) <
+                   std::tie(rhs.to, rhs.position, rhs.from);
+        });
+
+    std::vector<DAGEdge> result(merged.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, merged.size()), [&](const auto& range) {
+        for (auto i = range.begin(); i < range.end(); ++i)
+        {
+            result[i] = {merged[i].from, merged[i].to};
+        }
+    });
+    return result;
+}
+}  // namespace
+
+void BlockCriticals::append(
+    const std::vector<CriticalKey>& _keys, const std::vector<CriticalKey>& _sharedKeys)
+{
+    if (sharedOffsets.empty() && !_sharedKeys.empty())
+    {
+        sharedOffsets.assign(offsets.size(), 0);
+    }
+    keys.insert(keys.end(), _keys.begin(), _keys.end());
+    offsets.push_back((uint32_t)keys.size());
+    if (!sharedOffsets.empty())
+    {
+        sharedKeys.insert(sharedKeys.end(), _sharedKeys.begin(), _sharedKeys.end());
+        sharedOffsets.push_back((uint32_t)sharedKeys.size());
+    }
+}
+
+BlockCriticals BlockCriticals::fromFields(
+    const std::vector<std::vector<std::string>>& _txsCriticals)
+{
+    BlockCriticals result;
+    result.offsets.resize(_txsCriticals.size() + 1);
+    result.offsets[0] = 0;
+    for (size_t i = 0; i < _txsCriticals.size(); ++i)
+    {
+        result.offsets[i + 1] = result.offsets[i] + (uint32_t)_txsCriticals[i].size();
+    }
+
+    result.keys.resize(result.offsets.back());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, _txsCriticals.size()), [&](const auto& range) {
+            for (auto i = range.begin(); i < range.end(); ++i)
+            {
+                auto& criticals = _txsCriticals[i];
+                for (size_t j = 0; j < criticals.size(); ++j)
+                {
+                    result.keys[result.offsets[i] + j] = CriticalKey::hash(criticals[j]);
+                }
+            }
+        });
+    return result;
+}
+
+std::vector<DAGEdge> TxDAG::criticalEdges(const CriticalSpans& _criticals, bool _parallel)
+{
+    if (_criticals.offsets.empty())
+    {
+        return {};
+    }
+    assert(_criticals.sharedOffsets.empty() ||
+           _criticals.sharedOffsets.size() == _criticals.offsets.size());
+    if (_parallel)
+    {
+        return parallelCriticalEdges(_criticals);
+    }
+    return serialCriticalEdges(_criticals);
+}
+
+void TxDAG::reduceEdges(std::vector<DAGEdge>& _edges)
+{
+    if (_edges.empty())
+    {
+        return;
+    }
+
+    // Sources of every target, sorted and deduplicated, which is the in-edge list of the target
+    std::vector<ID> sources;
+    std::vector<size_t> sourceBegin;
+    std::vector<ID> targets;
+    sources.reserve(_edges.size());
+    size_t i = 0;
+    while (i < _edges.size())
+    {
+        auto target = _edges[i].second;
+        auto begin = sources.size();
+        for (; i < _edges.size() && _edges[i].second == target; ++i)
+        {
+            sources.push_back(_edges[i].first);
+        }
+        std::sort(sources.begin() + begin, sources.end());
+        sources.erase(std::unique(sources.begin() + begin, sources.end()), sources.end());
+        targets.push_back(target);
+        sourceBegin.push_back(begin);
+    }
+    sourceBegin.push_back(sources.size());
 
-            for (string const& c : criticals)
+    // In-edges of a vertex which is a target, empty otherwise
+    auto inEdges = [&](ID _id) -> std::pair<const ID*, const ID*> {
+        auto it = std::lower_bound(targets.begin(), targets.end(), _id);
+        if (it == targets.end() || *it != _id)
+        {
+            return {nullptr, nullptr};
+        }
+        auto index = it - targets.begin();
+        return {sources.data() + sourceBegin[index], sources.data() + sourceBegin[index + 1]};
+    };
+
+    // u -> v is implied if u -> w -> v for another source w of v. The edges implied by a longer
+    // path are kept, which only costs a redundant decrement of the in-degree.
+    _edges.clear();
+    for (size_t t = 0; t < targets.size(); ++t)
+    {
+        auto begin = sources.data() + sourceBegin[t];
+        auto end = sources.data() + sourceBegin[t + 1];
+        for (auto u = begin; u != end; ++u)
+        {
+            bool implied = false;
+            // every w depends on u only if w > u
+            for (auto w = u + 1; w != end && !implied; ++w)
             {
-                latestCriticals.update(c, id);
+                auto wSources = inEdges(*w);
+                implied = std::binary_search(wSources.first, wSources.second, *u);
+            }
+            if (!implied)
+            {
+                _edges.emplace_back(*u, targets[t]);
             }
         }
-        else
+    }
+}
+
+DAGStatistics TxDAG::computeStatistics(
+    gsl::span<const uint32_t> _offsets, const std::vector<DAGEdge>& _edges)
+{
+    DAGStatistics result;
+    if (_offsets.size() <= 1)
+    {
+        return result;
+    }
+    auto count = _offsets.size() - 1;
+
+    // Edges always go from a lower ID to a higher one, so ID order is a topological order, and
+    // the edges ordered by target visit every source after its own depth is final
+    std::vector<uint32_t> depth(count, 0);
+    for (size_t id = 0; id < count; ++id)
+    {
+        if (_offsets[id + 1] > _offsets[id])
+        {
+            depth[id] = 1;
+            ++result.vertexNum;
+        }
+    }
+    for (auto& edge : _edges)
+    {
+        depth[edge.second] = std::max(depth[edge.second], depth[edge.first] + 1);
+    }
+
+    std::vector<size_t> levelWidth;
+    for (auto d : depth)
+    {
+        if (d == 0)
         {
             continue;
         }
+        if (levelWidth.size() < d)
+        {
+            levelWidth.resize(d, 0);
+        }
+        ++levelWidth[d - 1];
     }
 
+    result.edgeNum = _edges.size();
+    result.longestPath = levelWidth.size();
+    result.widestLevel =
+        levelWidth.empty() ? 0 : *std::max_element(levelWidth.begin(), levelWidth.end());
+    result.speedupBound =
+        result.longestPath == 0 ? 0 : (double)result.vertexNum / (double)result.longestPath;
+    return result;
+}
+
+// Generate DAG according with given transactions
+void TxDAG::init(size_t count, const std::vector<std::vector<std::string>>& _txsCriticals)
+{
+    assert(count == _txsCriticals.size());
+    (void)count;
+    init(BlockCriticals::fromFields(_txsCriticals));
+}
+
+void TxDAG::init(const CriticalSpans& _criticals)
+{
+    auto& offsets = _criticals.offsets;
+    auto txsSize = offsets.empty() ? 0 : offsets.size() - 1;
+    DAG_LOG(TRACE) << LOG_DESC("Begin init transaction DAG") << LOG_KV("transactionNum", txsSize);
+
+    auto edges = criticalEdges(_criticals, txsSize >= m_parallelInitThreshold);
+    if (m_reduceEdges)
+    {
+        reduceEdges(edges);
+    }
+    m_statistics = computeStatistics(offsets, edges);
+
     // Generate DAG
-    m_dag.generate();
+    switch (m_schedulerType)
+    {
+    case DAGSchedulerType::WorkStealing:
+        m_wsDag.init(txsSize, m_workerNum);
+        m_wsDag.addEdges(std::move(edges));
+        m_wsDag.generate();
+        break;
+    case DAGSchedulerType::CriticalPath:
+        m_priorityDag.init(txsSize);
+        m_priorityDag.setWeights(std::move(m_weights));
+        m_priorityDag.addEdges(std::move(edges));
+        m_priorityDag.generate();
+        break;
+    default:
+        m_dag.init(txsSize);
+        m_dag.addEdges(std::move(edges));
+        m_dag.generate();
+        break;
+    }
 
     m_totalParaTxs = txsSize;
 
-    DAG_LOG(TRACE) << LOG_DESC("End init transaction DAG");
+    DAG_LOG(DEBUG) << LOG_DESC("End init transaction DAG")
+                   << LOG_KV("vertexes", m_statistics.vertexNum)
+                   << LOG_KV("edges", m_statistics.edgeNum)
+                   << LOG_KV("longestPath", m_statistics.longestPath)
+                   << LOG_KV("widestLevel", m_statistics.widestLevel)
+                   << LOG_KV("speedupBound", m_statistics.speedupBound);
 }
 
 // Set transaction execution function
@@ -83,27 +421,92 @@ void TxDAG::setTxExecuteFunc(ExecuteTxFunc const& _f)
 
 int TxDAG::executeUnit(const vector<TransactionExecutive::Ptr>& allExecutives,
     vector<std::unique_ptr<CallParameters>>& allCallParameters,
-    const std::vector<gsl::index>& allIndex)
+    const std::vector<gsl::index>& allIndex, size_t _workerId)
 {
     int exeCnt = 0;
-    ID id = m_dag.waitPop();
+    _workerId %= m_workerNum;
+    auto waitPop = [&]() {
+        switch (m_schedulerType)
+        {
+        case DAGSchedulerType::WorkStealing:
+            return m_wsDag.waitPop(_workerId);
+        case DAGSchedulerType::CriticalPath:
+            return m_priorityDag.waitPop();
+        default:
+            return m_dag.waitPop();
+        }
+    };
+    auto consume = [&](ID _id) {
+        switch (m_schedulerType)
+        {
+        case DAGSchedulerType::WorkStealing:
+            return m_wsDag.consume(_workerId, _id);
+        case DAGSchedulerType::CriticalPath:
+            return m_priorityDag.consume(_id);
+        default:
+            return m_dag.consume(_id);
+        }
+    };
+    // stop dispatching once stopped or the deadline passed
+    auto canDispatch = [&]() {
+        if (m_stop.load())
+        {
+            return false;
+        }
+        if (m_hasDeadline && std::chrono::steady_clock::now() >= m_deadline)
+        {
+            m_isTimeout.store(true);
+            stop();
+            return false;
+        }
+        return true;
+    };
+
+    auto& statistics = m_workerStatistics[_workerId];
+    auto now = std::chrono::steady_clock::now();
+    ID id = waitPop();
     while (id != INVALID_ID)
     {
+        auto popped = std::chrono::steady_clock::now();
+        statistics.idle += popped - now;
         do
         {
+            if (!canDispatch())
+            {
+                id = INVALID_ID;
+                break;
+            }
             exeCnt += 1;
             if (allExecutives[id] && allCallParameters.at(id))
             {
                 f_executeTx(allExecutives[id], std::move(allCallParameters.at(id)), allIndex[id]);
+                ++statistics.executed;
             }
-            id = m_dag.consume(id);
+            id = consume(id);
         } while (id != INVALID_ID);
-        id = m_dag.waitPop();
+        now = std::chrono::steady_clock::now();
+        statistics.busy += now - popped;
+        if (m_stop.load())
+        {
+            break;
+        }
+        id = waitPop();
     }
+    statistics.idle += std::chrono::steady_clock::now() - now;
     if (exeCnt > 0)
     {
-        Guard l(x_exeCnt);
-        m_exeCnt += exeCnt;
+        m_exeCnt.fetch_add(exeCnt);
     }
     return exeCnt;
 }
+
+void TxDAG::run(const std::vector<TransactionExecutive::Ptr>& allExecutives,
+    std::vector<std::unique_ptr<CallParameters>>& allCallParameters,
+    const std::vector<gsl::index>& allIndex, size_t _workerId)
+{
+    // only the classic scheduler returns INVALID_ID before the end, after polling for 10ms
+    while (!hasFinished())
+    {
+        executeUnit(allExecutives, allCallParameters, allIndex, _workerId);
+    }
+}
@@ -25,12 +25,17 @@
 #include "../executive/BlockContext.h"
 #include "../executive/TransactionExecutive.h"
 #include "DAG.h"
+#include "PriorityDAG.h"
+#include "WorkStealingDAG.h"
 #include "bcos-executor/TransactionExecutor.h"
 #include "bcos-framework/interfaces/protocol/Block.h"
 #include "bcos-framework/interfaces/protocol/Transaction.h"
+#include <gsl/span>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <queue>
+#include <string_view>
 #include <vector>
 
 namespace bcos
@@ -59,15 +64,116 @@ enum EnvKind : std::uint8_t
     Addr,
 };
 
+// View of the criticals of a block, see BlockCriticals
+struct CriticalSpans
+{
+    gsl::span<const CriticalKey> keys;
+    gsl::span<const uint32_t> offsets;
+    gsl::span<const CriticalKey> sharedKeys;
+    gsl::span<const uint32_t> sharedOffsets;
+};
+
+// Critical keys of all transactions in a block in one flat array, the keys of transaction i are
+// keys[offsets[i], offsets[i + 1]). Every key is accessed exclusively, except the shared keys in
+// sharedKeys[sharedOffsets[i], sharedOffsets[i + 1]), e.g. the slot of a keyed access, which only
+// conflict with the exclusive accesses of the same key. sharedOffsets is empty if no transaction
+// has shared keys.
+struct BlockCriticals
+{
+    std::vector<CriticalKey> keys;
+    std::vector<uint32_t> offsets = {0};
+    std::vector<CriticalKey> sharedKeys;
+    std::vector<uint32_t> sharedOffsets;
+
+    size_t size() const { return offsets.size() - 1; }
+
+    // Append the criticals of the next transaction
+    void append(
+        const std::vector<CriticalKey>& _keys, const std::vector<CriticalKey>& _sharedKeys = {});
+
+    CriticalSpans spans() const { return {keys, offsets, sharedKeys, sharedOffsets}; }
+
+    // Hash the fields of all transactions in parallel
+    static BlockCriticals fromFields(const std::vector<std::vector<std::string>>& _txsCriticals);
+};
+
+// Shape of a transaction DAG, only the transactions with critical fields are counted
+struct DAGStatistics
+{
+    size_t vertexNum = 0;
+    size_t edgeNum = 0;
+    // number of vertexes on the longest dependency chain
+    size_t longestPath = 0;
+    // max number of vertexes at the same depth
+    size_t widestLevel = 0;
+    // vertexNum / longestPath, the speedup with unlimited workers and unit cost transactions
+    double speedupBound = 0;
+};
+
+// Time a worker spent on executing transactions and on waiting for ready ones
+struct DAGWorkerStatistics
+{
+    std::chrono::nanoseconds busy = std::chrono::nanoseconds(0);
+    std::chrono::nanoseconds idle = std::chrono::nanoseconds(0);
+    size_t executed = 0;
+};
+
 class TxDAG
 {
 public:
-    TxDAG() : m_dag() {}
+    TxDAG(DAGSchedulerType _schedulerType = DAGSchedulerType::Classic, size_t _workerNum = 1)
+      : m_dag(),
+        m_schedulerType(_schedulerType),
+        m_workerNum(std::max<size_t>(_workerNum, 1)),
+        m_workerStatistics(m_workerNum)
+    {}
     virtual ~TxDAG() {}
 
     // Generate DAG according with given transactions
     void init(size_t count, const std::vector<std::vector<std::string>>& _txsCriticals);
 
+    // Generate DAG according with the hashed criticals, the keys of transaction i are
+    // _keys[_offsets[i], _offsets[i + 1]), nothing is allocated per transaction
+    void init(gsl::span<const CriticalKey> _keys, gsl::span<const uint32_t> _offsets)
+    {
+        init(CriticalSpans{_keys, _offsets, {}, {}});
+    }
+    void init(const CriticalSpans& _criticals);
+    void init(const BlockCriticals& _criticals) { init(_criticals.spans()); }
+
+    // Edges between the transactions which share a critical field, every transaction depends on
+    // the last former transaction which has the same field. The edges are ordered by (target,
+    // position of the field in the target's criticals), no matter whether computed in parallel.
+    static std::vector<DAGEdge> criticalEdges(gsl::span<const CriticalKey> _keys,
+        gsl::span<const uint32_t> _offsets, bool _parallel)
+    {
+        return criticalEdges(CriticalSpans{_keys, _offsets, {}, {}}, _parallel);
+    }
+
+    // Same as above with shared keys, a transaction also depends on the shared accessors of its
+    // exclusive keys since their last exclusive accessor, the shared keys are positioned after
+    // the exclusive ones
+    static std::vector<DAGEdge> criticalEdges(const CriticalSpans& _criticals, bool _parallel);
+
+    // Remove duplicated edges and the edges implied by a path of two edges, the edges must be
+    // ordered by target, the result is ordered by (target, source)
+    static void reduceEdges(std::vector<DAGEdge>& _edges);
+
+    static DAGStatistics computeStatistics(
+        gsl::span<const uint32_t> _offsets, const std::vector<DAGEdge>& _edges);
+
+    // Blocks with at least this number of transactions build the DAG in parallel
+    void setParallelInitThreshold(size_t _threshold) { m_parallelInitThreshold = _threshold; }
+
+    // Run reduceEdges() before generating the DAG
+    void setEdgeReduction(bool _reduce) { m_reduceEdges = _reduce; }
+
+    // Cost estimate of every transaction used by the critical path scheduler, call before init()
+    void setTxWeights(std::vector<uint64_t> _weights) { m_weights = std::move(_weights); }
+
+    // Statistics of the DAG built by the last init()
+    const DAGStatistics& statistics() const { return m_statistics; }
+
     // Set transaction execution function
     void setTxExecuteFunc(ExecuteTxFunc const& _f);
 
@@ -80,26 +186,76 @@ public:
 
     // Called by thread
     // Execute a unit in DAG
-    // This function can be parallel
+    // This function can be parallel, every concurrent caller must pass a distinct _workerId in
+    // [0, workerNum)
     int executeUnit(const std::vector<TransactionExecutive::Ptr>& allExecutives,
         std::vector<std::unique_ptr<CallParameters>>& allCallParameters,
-        const std::vector<gsl::index>& allIndex);
+        const std::vector<gsl::index>& allIndex, size_t _workerId = 0);
+
+    // Called by thread
+    // Execute units until the DAG reach the end, or is stopped by stop() or the deadline
+    void run(const std::vector<TransactionExecutive::Ptr>& allExecutives,
+        std::vector<std::unique_ptr<CallParameters>>& allCallParameters,
+        const std::vector<gsl::index>& allIndex, size_t _workerId);
 
     ID paraTxsNumber() { return m_totalParaTxs; }
 
     ID haveExecuteNumber() { return m_exeCnt; }
-    void stop() { m_stop.store(true); }
+
+    // No transaction is dispatched after the deadline, the running ones are not interrupted. What
+    // is dispatched before it depends on timing, the caller must discard a stopped execution.
+    void setDeadline(std::chrono::steady_clock::time_point _deadline)
+    {
+        m_deadline = _deadline;
+        m_hasDeadline = true;
+    }
+    bool isTimeout() const { return m_isTimeout.load(); }
+    bool isStopped() const { return m_stop.load(); }
+
+    // Statistics of every worker, read after all workers return
+    const std::vector<DAGWorkerStatistics>& workerStatistics() const
+    {
+        return m_workerStatistics;
+    }
+
+    // Stop dispatching transactions and wake up all waiting workers
+    void stop()
+    {
+        m_stop.store(true);
+        if (m_schedulerType == DAGSchedulerType::WorkStealing)
+        {
+            m_wsDag.stop();
+        }
+        else if (m_schedulerType == DAGSchedulerType::CriticalPath)
+        {
+            m_priorityDag.stop();
+        }
+    }
+
+    DAGSchedulerType schedulerType() const { return m_schedulerType; }
+    size_t workerNum() const { return m_workerNum; }
 
 private:
     ExecuteTxFunc f_executeTx;
     bcos::protocol::TransactionsPtr m_transactions;
     DAG m_dag;
+    WorkStealingDAG m_wsDag;
+    PriorityDAG m_priorityDag;
+    std::vector<uint64_t> m_weights;
+    DAGSchedulerType m_schedulerType;
+    size_t m_workerNum;
+    size_t m_parallelInitThreshold = 4096;
+    bool m_reduceEdges = false;
+    DAGStatistics m_statistics;
 
-    ID m_exeCnt = 0;
+    std::atomic<ID> m_exeCnt = {0};
     ID m_totalParaTxs = 0;
 
-    mutable std::mutex x_exeCnt;
     std::atomic_bool m_stop = {false};
+    std::atomic_bool m_isTimeout = {false};
+    bool m_hasDeadline = false;
+    std::chrono::steady_clock::time_point m_deadline;
+    std::vector<DAGWorkerStatistics> m_workerStatistics;
 };
 
 template <typename T>
@@ -142,5 +298,104 @@ private:
     ID m_criticalAll = INVALID_ID;
 };
 
+// Open addressing table keyed by the hashed fields, which needs no allocation per update once
+// reserved
+template <>
+class CriticalField<CriticalKey>
+{
+public:
+    void reserve(size_t _size)
+    {
+        size_t capacity = 16;
+        while (capacity < _size * 2)
+        {
+            capacity <<= 1;
+        }
+        if (capacity > m_slots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    ID get(CriticalKey const& _c) const
+    {
+        if (!m_slots.empty())
+        {
+            auto& slot = m_slots[find(_c)];
+            if (slot.second != INVALID_ID)
+            {
+                return slot.second;
+            }
+        }
+        return m_criticalAll;
+    }
+
+    void update(CriticalKey const& _c, ID _txId)
+    {
+        if ((m_size + 1) * 2 > m_slots.size())
+        {
+            rehash(std::max<size_t>(m_slots.size() * 2, 16));
+        }
+        auto& slot = m_slots[find(_c)];
+        if (slot.second == INVALID_ID)
+        {
+            slot.first = _c;
+            ++m_size;
+        }
+        slot.second = _txId;
+    }
+
+    void foreachField(std::function<void(ID)> _f)
+    {
+        for (auto const& slot : m_slots)
+        {
+            if (slot.second != INVALID_ID)
+            {
+                _f(slot.second);
+            }
+        }
+
+        if (m_criticalAll != INVALID_ID)
+            _f(m_criticalAll);
+    }
+
+    void setCriticalAll(ID _id)
+    {
+        m_criticalAll = _id;
+        std::fill(m_slots.begin(), m_slots.end(), std::make_pair(CriticalKey(), INVALID_ID));
+        m_size = 0;
+    }
+
+private:
+    // Index of the slot holding _c, or the empty slot where _c should be
+    size_t find(CriticalKey const& _c) const
+    {
+        auto mask = m_slots.size() - 1;
+        auto index = _c.low & mask;
+        while (m_slots[index].second != INVALID_ID && m_slots[index].first != _c)
+        {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void rehash(size_t _capacity)
+    {
+        auto slots = std::move(m_slots);
+        m_slots.assign(_capacity, std::make_pair(CriticalKey(), INVALID_ID));
+        for (auto const& slot : slots)
+        {
+            if (slot.second != INVALID_ID)
+            {
+                m_slots[find(slot.first)] = slot;
+            }
+        }
+    }
+
+    std::vector<std::pair<CriticalKey, ID>> m_slots;
+    size_t m_size = 0;
+    ID m_criticalAll = INVALID_ID;
+};
+
 }  // namespace executor
 }  // namespace bcos
@@ -0,0 +1,361 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : DAG scheduler with per-worker work-stealing deques
+ * @file WorkStealingDAG.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-06
+ */
+
+#include "WorkStealingDAG.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+namespace
+{
+// Rounds of stealing before an idle worker parks itself
+const int c_spinRounds = 64;
+
+size_t roundUpPowerOfTwo(size_t _value)
+{
+    size_t result = 1;
+    while (result < _value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace
+
+WorkStealingDeque::WorkStealingDeque(size_t _capacity)
+{
+    m_buffers.emplace_back(make_unique<Buffer>(roundUpPowerOfTwo(std::max<size_t>(_capacity, 2))));
+    m_buffer.store(m_buffers.back().get(), memory_order_relaxed);
+}
+
+WorkStealingDeque::~WorkStealingDeque() = default;
+
+void WorkStealingDeque::push(ID _id)
+{
+    auto bottom = m_bottom.load(memory_order_relaxed);
+    auto top = m_top.load(memory_order_acquire);
+    auto buffer = m_buffer.load(memory_order_relaxed);
+    if (bottom - top > (int64_t)buffer->capacity() - 1)
+    {
+        buffer = grow(buffer, top, bottom);
+    }
+    buffer->put(bottom, _id);
+    atomic_thread_fence(memory_order_release);
+    m_bottom.store(bottom + 1, memory_order_relaxed);
+}
+
+ID WorkStealingDeque::pop()
+{
+    auto bottom = m_bottom.load(memory_order_relaxed) - 1;
+    auto buffer = m_buffer.load(memory_order_relaxed);
+    m_bottom.store(bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    auto top = m_top.load(memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // empty
+        m_bottom.store(bottom + 1, memory_order_relaxed);
+        return INVALID_ID;
+    }
+
+    ID id = buffer->get(bottom);
+    if (top == bottom)
+    {
+        // the last one, race with the thieves
+        if (!m_top.compare_exchange_strong(
+                top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            id = INVALID_ID;
+        }
+        m_bottom.store(bottom + 1, memory_order_relaxed);
+    }
+    return id;
+}
+
+ID WorkStealingDeque::steal(bool& _retry)
+{
+    auto top = m_top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    auto bottom = m_bottom.load(memory_order_acquire);
+    if (top >= bottom)
+    {
+        return INVALID_ID;
+    }
+
+    auto buffer = m_buffer.load(memory_order_acquire);
+    ID id = buffer->get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        _retry = true;
+        return INVALID_ID;
+    }
+    return id;
+}
+
+WorkStealingDeque::Buffer* WorkStealingDeque::grow(Buffer* _buffer, int64_t _top, int64_t _bottom)
+{
+    auto newBuffer = make_unique<Buffer>(_buffer->capacity() * 2);
+    for (auto i = _top; i < _bottom; ++i)
+    {
+        newBuffer->put(i, _buffer->get(i));
+    }
+    auto result = newBuffer.get();
+    m_buffers.emplace_back(std::move(newBuffer));
+    m_buffer.store(result, memory_order_release);
+    return result;
+}
+
+uint32_t EventCount::prepareWait()
+{
+    m_waiters.fetch_add(1, memory_order_seq_cst);
+    return m_epoch.load(memory_order_seq_cst);
+}
+
+void EventCount::cancelWait()
+{
+    m_waiters.fetch_sub(1, memory_order_seq_cst);
+}
+
+void EventCount::commitWait(uint32_t _key)
+{
+#ifdef __linux__
+    while (m_epoch.load(memory_order_acquire) == _key)
+    {
+        // spurious wakeup and EINTR are handled by the loop
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAIT_PRIVATE, _key,
+            nullptr, nullptr, 0);
+    }
+#else
+    {
+        std::unique_lock<std::mutex> lock(x_epoch);
+        cv_epoch.wait(lock, [&]() { return m_epoch.load(memory_order_acquire) != _key; });
+    }
+#endif
+    m_waiters.fetch_sub(1, memory_order_seq_cst);
+}
+
+void EventCount::notify(uint32_t _num)
+{
+    // pairs with the seq_cst increment in prepareWait, the waiter either sees the new work in its
+    // re-check, or we see it in m_waiters
+    atomic_thread_fence(memory_order_seq_cst);
+    if (m_waiters.load(memory_order_relaxed) == 0)
+    {
+        return;
+    }
+    wake(_num);
+}
+
+void EventCount::notifyAll()
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (m_waiters.load(memory_order_relaxed) == 0)
+    {
+        return;
+    }
+    wake(UINT32_MAX);
+}
+
+void EventCount::wake(uint32_t _num)
+{
+#ifdef __linux__
+    m_epoch.fetch_add(1, memory_order_seq_cst);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_epoch), FUTEX_WAKE_PRIVATE,
+        (int)std::min<uint32_t>(_num, INT_MAX), nullptr, nullptr, 0);
+#else
+    {
+        std::lock_guard<std::mutex> lock(x_epoch);
+        m_epoch.fetch_add(1, memory_order_seq_cst);
+    }
+    if (_num == 1)
+    {
+        cv_epoch.notify_one();
+    }
+    else
+    {
+        cv_epoch.notify_all();
+    }
+#endif
+}
+
+WorkStealingDAG::~WorkStealingDAG()
+{
+    clear();
+}
+
+void WorkStealingDAG::init(ID _maxSize, size_t _workerNum, size_t _edgeHint)
+{
+    clear();
+    _workerNum = std::max<size_t>(_workerNum, 1);
+    m_graph.init(_maxSize, _edgeHint);
+    // every vertex is pushed at most once, reserve enough space for the average share so that
+    // the deques seldom grow during execution
+    auto capacity = _maxSize / _workerNum + 1;
+    for (size_t i = 0; i < _workerNum; ++i)
+    {
+        m_deques.emplace_back(make_unique<WorkStealingDeque>(capacity));
+    }
+    m_totalVtxs = _maxSize;
+    m_totalConsume = 0;
+    m_stop = false;
+}
+
+void WorkStealingDAG::addEdge(ID _f, ID _t)
+{
+    m_graph.addEdge(_f, _t);
+}
+
+void WorkStealingDAG::generate()
+{
+    // Called before the workers start. Push in reverse order so every owner pops its roots in
+    // ascending ID order.
+    m_graph.build();
+    std::vector<ID> roots;
+    for (ID id = 0; id < m_graph.size(); ++id)
+    {
+        if (m_graph.inDegree(id).load(memory_order_relaxed) == 0)
+            roots.push_back(id);
+    }
+    for (auto i = roots.size(); i > 0; --i)
+    {
+        m_deques[(i - 1) % m_deques.size()]->push(roots[i - 1]);
+    }
+}
+
+ID WorkStealingDAG::trySteal(size_t _workerId)
+{
+    auto workerNum = m_deques.size();
+    bool retry = true;
+    while (retry)
+    {
+        retry = false;
+        for (size_t i = 1; i < workerNum; ++i)
+        {
+            auto id = m_deques[(_workerId + i) % workerNum]->steal(retry);
+            if (id != INVALID_ID)
+            {
+                return id;
+            }
+        }
+    }
+    return INVALID_ID;
+}
+
+ID WorkStealingDAG::waitPop(size_t _workerId, bool _needWait)
+{
+    assert(_workerId < m_deques.size());
+    auto& local = *m_deques[_workerId];
+    while (true)
+    {
+        for (int round = 0; round < c_spinRounds; ++round)
+        {
+            auto id = local.pop();
+            if (id == INVALID_ID)
+            {
+                id = trySteal(_workerId);
+            }
+            if (id != INVALID_ID)
+            {
+                return id;
+            }
+            if (finished() || !_needWait)
+            {
+                return INVALID_ID;
+            }
+            std::this_thread::yield();
+        }
+
+        auto key = m_idle.prepareWait();
+        auto id = local.pop();
+        if (id == INVALID_ID)
+        {
+            id = trySteal(_workerId);
+        }
+        if (id != INVALID_ID)
+        {
+            m_idle.cancelWait();
+            return id;
+        }
+        if (finished())
+        {
+            m_idle.cancelWait();
+            return INVALID_ID;
+        }
+        m_idle.commitWait(key);
+    }
+}
+
+ID WorkStealingDAG::consume(size_t _workerId, ID _id)
+{
+    ID producedNum = 0;
+    ID nextId = INVALID_ID;
+    for (auto it = m_graph.outEdgesBegin(_id); it != m_graph.outEdgesEnd(_id); ++it)
+    {
+        ID id = *it;
+        if (m_graph.inDegree(id).fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            ++producedNum;
+            if (producedNum == 1)
+            {
+                nextId = id;
+            }
+            else
+            {
+                m_deques[_workerId]->push(id);
+            }
+        }
+    }
+    if (producedNum > 1)
+    {
+        m_idle.notify(producedNum - 1);
+    }
+
+    if (m_totalConsume.fetch_add(1, memory_order_acq_rel) + 1 == m_totalVtxs)
+    {
+        m_idle.notifyAll();
+    }
+    return nextId;
+}
+
+void WorkStealingDAG::stop()
+{
+    m_stop.store(true);
+    m_idle.notifyAll();
+}
+
+void WorkStealingDAG::clear()
+{
+    m_graph.clear();
+    m_deques.clear();
+}
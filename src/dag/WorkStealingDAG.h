@@ -0,0 +1,161 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : DAG scheduler with per-worker work-stealing deques
+ * @file WorkStealingDAG.h
+ * @author: xingqiangbai
+ * @date: 2021-12-06
+ */
+
+#pragma once
+#include "DAG.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bcos
+{
+namespace executor
+{
+// Chase-Lev deque of vertex IDs. push/pop may only be called by the owner worker, steal may be
+// called by any worker. Retired buffers are kept until the deque is destroyed, so a thief never
+// reads freed memory.
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(size_t _capacity = 64);
+    ~WorkStealingDeque();
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Push to the bottom, owner only
+    void push(ID _id);
+
+    // Pop from the bottom, owner only, return INVALID_ID if empty
+    ID pop();
+
+    // Steal from the top, return INVALID_ID if empty or lost the race with another worker
+    ID steal(bool& _retry);
+
+private:
+    struct Buffer
+    {
+        explicit Buffer(size_t _capacity)
+          : mask(_capacity - 1), slots(new std::atomic<ID>[_capacity])
+        {}
+        size_t capacity() const { return mask + 1; }
+        ID get(int64_t _index) const
+        {
+            return slots[_index & mask].load(std::memory_order_relaxed);
+        }
+        void put(int64_t _index, ID _id)
+        {
+            slots[_index & mask].store(_id, std::memory_order_relaxed);
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<ID>[]> slots;
+    };
+
+    Buffer* grow(Buffer* _buffer, int64_t _top, int64_t _bottom);
+
+    alignas(64) std::atomic<int64_t> m_top = {0};
+    alignas(64) std::atomic<int64_t> m_bottom = {0};
+    alignas(64) std::atomic<Buffer*> m_buffer;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+// Event count used to park idle workers. On linux the waiters sleep on a futex, elsewhere on a
+// condition variable. A waiter calls prepareWait(), re-checks its condition, then either
+// cancelWait() or commitWait(), so a notify between the check and the sleep is never lost.
+class EventCount
+{
+public:
+    uint32_t prepareWait();
+    void cancelWait();
+    void commitWait(uint32_t _key);
+
+    void notify(uint32_t _num = 1);
+    void notifyAll();
+
+private:
+    void wake(uint32_t _num);
+
+    alignas(64) std::atomic<uint32_t> m_epoch = {0};
+    alignas(64) std::atomic<uint32_t> m_waiters = {0};
+#ifndef __linux__
+    std::mutex x_epoch;
+    std::condition_variable cv_epoch;
+#endif
+};
+
+class WorkStealingDAG
+{
+public:
+    WorkStealingDAG() = default;
+    ~WorkStealingDAG();
+
+    // Init DAG basic memory, should call before other function
+    // _maxSize is max ID + 1, _workerNum is the number of workers which call waitPop/consume,
+    // _edgeHint is the expected number of edges
+    void init(ID _maxSize, size_t _workerNum, size_t _edgeHint = 0);
+
+    // Add edge between vertex
+    void addEdge(ID _f, ID _t);
+    void addEdges(std::vector<DAGEdge>&& _edges) { m_graph.addEdges(std::move(_edges)); }
+
+    // Generate DAG, build the vertex storage from the added edges, the top level vertexes are
+    // distributed to the workers round-robin
+    void generate();
+
+    // Pop a ready vertex from the local deque, or steal one from another worker. Park the worker
+    // if nothing is ready, return INVALID_ID if DAG reach the end or stopped
+    ID waitPop(size_t _workerId, bool _needWait = true);
+
+    // Consume the vertex, return the first vertex which becomes ready, the others are pushed to
+    // the local deque of _workerId (thread safe)
+    ID consume(size_t _workerId, ID _id);
+
+    // Wake up all parked workers and make waitPop return INVALID_ID
+    void stop();
+
+    void clear();
+
+    size_t workerNum() const { return m_deques.size(); }
+    size_t edgeNum() const { return m_graph.edgeNum(); }
+
+private:
+    ID trySteal(size_t _workerId);
+    bool finished() const
+    {
+        return m_totalConsume.load(std::memory_order_acquire) >= m_totalVtxs || m_stop.load();
+    }
+
+    CSRGraph m_graph;
+    std::vector<std::unique_ptr<WorkStealingDeque>> m_deques;
+    EventCount m_idle;
+
+    ID m_totalVtxs = 0;
+    std::atomic<ID> m_totalConsume = {0};
+    std::atomic_bool m_stop = {false};
+};
+
+}  // namespace executor
+}  // namespace bcos
@@ -77,6 +77,11 @@ void BlockContext::insertExecutive(int64_t contextID, int64_t seq, ExecutiveStat
     std::tie(it, success) = m_executives.emplace(std::tuple{contextID, seq}, std::move(state));
 }
 
+void BlockContext::eraseExecutive(int64_t contextID, int64_t seq)
+{
+    m_executives.unsafe_erase(std::tuple{contextID, seq});
+}
+
 bcos::executor::BlockContext::ExecutiveState* BlockContext::getExecutive(
     int64_t contextID, int64_t seq)
 {
@@ -37,6 +37,10 @@
 
 namespace bcos
 {
+namespace precompiled
+{
+class ParallelConfigCache;
+}
 namespace executor
 {
 class TransactionExecutive;
@@ -90,8 +94,21 @@ public:
 
     ExecutiveState* getExecutive(int64_t contextID, int64_t seq);
 
+    // Not thread safe, must not run with the other accesses of the executives
+    void eraseExecutive(int64_t contextID, int64_t seq);
+
     void clear() { m_executives.clear(); }
 
+    // the writes of parallel configs invalidate the cache, null if there is no cache
+    const std::shared_ptr<precompiled::ParallelConfigCache>& parallelConfigCache() const
+    {
+        return m_parallelConfigCache;
+    }
+    void setParallelConfigCache(std::shared_ptr<precompiled::ParallelConfigCache> _cache)
+    {
+        m_parallelConfigCache = std::move(_cache);
+    }
+
 private:
     struct HashCombine
     {
@@ -123,6 +140,7 @@ private:
     std::shared_ptr<storage::StateStorage> m_storage;
     bcos::storage::StorageInterface::Ptr m_lastStorage = nullptr;
     crypto::Hash::Ptr m_hashImpl;
+    std::shared_ptr<precompiled::ParallelConfigCache> m_parallelConfigCache;
 };
 
 }  // namespace executor
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the precompiled contracts of an executor
+ * @file PrecompiledRegistry.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-14
+ */
+
+#include "PrecompiledRegistry.h"
+#include "bcos-framework/libutilities/Error.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+bool PrecompiledRegistry::toKey(std::string_view _address, Key& _key)
+{
+    if (_address.size() > MAX_ADDRESS_SIZE)
+    {
+        return false;
+    }
+    _key.fill(0);
+    memcpy(_key.data(), _address.data(), _address.size());
+    return true;
+}
+
+int32_t PrecompiledRegistry::lowAddress(std::string_view _address)
+{
+    constexpr size_t prefixSize = MAX_ADDRESS_SIZE - 4;
+    static const std::string zeros(prefixSize, '0');
+
+    if (_address.size() != MAX_ADDRESS_SIZE ||
+        memcmp(_address.data(), zeros.data(), prefixSize) != 0)
+    {
+        return -1;
+    }
+    int32_t value = 0;
+    for (auto c : _address.substr(prefixSize))
+    {
+        // lowercase only, as the registered addresses, so that classify() agrees with find()
+        int32_t digit;
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+void PrecompiledRegistry::setClass(std::string_view _address, AddressClass _class)
+{
+    auto low = lowAddress(_address);
+    if (low >= 0)
+    {
+        (_class == BUILT_IN ? m_builtInLow : m_ethereumLow).set(low);
+    }
+    else
+    {
+        m_namedClasses[std::string(_address)] |= _class;
+    }
+}
+
+PrecompiledRegistry::Entry& PrecompiledRegistry::emplace(std::string_view _address)
+{
+    Key key;
+    if (!toKey(_address, key))
+    {
+        BOOST_THROW_EXCEPTION(BCOS_ERROR(-1, "Precompiled address too long: " + string(_address)));
+    }
+    auto it = lower_bound(m_keys.begin(), m_keys.end(), key);
+    auto index = it - m_keys.begin();
+    if (it == m_keys.end() || *it != key)
+    {
+        m_keys.insert(it, key);
+        m_entries.insert(m_entries.begin() + index, Entry());
+    }
+    return m_entries[index];
+}
+
+void PrecompiledRegistry::setPrecompiled(
+    std::string_view _address, std::shared_ptr<precompiled::Precompiled> _precompiled)
+{
+    emplace(_address).precompiled = std::move(_precompiled);
+}
+
+void PrecompiledRegistry::setEVMPrecompiled(
+    std::string_view _address, std::shared_ptr<PrecompiledContract> _precompiled)
+{
+    emplace(_address).evmPrecompiled = std::move(_precompiled);
+    setClass(_address, ETHEREUM);
+}
+
+void PrecompiledRegistry::setBuiltIn(std::string_view _address)
+{
+    emplace(_address).builtIn = true;
+    setClass(_address, BUILT_IN);
+}
+
+const PrecompiledRegistry::Entry* PrecompiledRegistry::find(std::string_view _address) const
+{
+    Key key;
+    if (!toKey(_address, key))
+    {
+        return nullptr;
+    }
+    auto it = lower_bound(m_keys.begin(), m_keys.end(), key);
+    if (it == m_keys.end() || *it != key)
+    {
+        return nullptr;
+    }
+    return &m_entries[it - m_keys.begin()];
+}
+
+std::shared_ptr<precompiled::Precompiled> PrecompiledRegistry::getPrecompiled(
+    std::string_view _address) const
+{
+    auto entry = find(_address);
+    return entry ? entry->precompiled : nullptr;
+}
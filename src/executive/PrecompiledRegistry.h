@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the precompiled contracts of an executor
+ * @file PrecompiledRegistry.h
+ * @author: xingqiangbai
+ * @date: 2021-12-14
+ */
+
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bcos
+{
+namespace precompiled
+{
+class Precompiled;
+}
+namespace executor
+{
+class PrecompiledContract;
+
+// The constant, built-in and ethereum precompiled contracts in one sorted flat array. It is filled
+// by the executor once and then shared immutably by all its executives.
+class PrecompiledRegistry
+{
+public:
+    using Ptr = std::shared_ptr<const PrecompiledRegistry>;
+
+    // EVM addresses are 40 hex chars, the names of the WASM precompiled are not longer
+    static constexpr size_t MAX_ADDRESS_SIZE = 40;
+    // addresses of 36 leading zeros, the system addresses of all the built-in precompiled
+    static constexpr size_t LOW_ADDRESS_NUM = 0x10000;
+
+    // How HostContext treats a called address, a bitmask
+    enum AddressClass : uint8_t
+    {
+        NONE = 0,
+        BUILT_IN = 1,
+        ETHEREUM = 2,
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<precompiled::Precompiled> precompiled;
+        std::shared_ptr<PrecompiledContract> evmPrecompiled;
+        // executed in place by HostContext instead of as an external call
+        bool builtIn = false;
+    };
+
+    // Register before sharing, throw if _address is longer than MAX_ADDRESS_SIZE
+    void setPrecompiled(
+        std::string_view _address, std::shared_ptr<precompiled::Precompiled> _precompiled);
+    void setEVMPrecompiled(
+        std::string_view _address, std::shared_ptr<PrecompiledContract> _precompiled);
+    void setBuiltIn(std::string_view _address);
+
+    // Null if nothing is registered at _address
+    const Entry* find(std::string_view _address) const;
+
+    std::shared_ptr<precompiled::Precompiled> getPrecompiled(std::string_view _address) const;
+
+    // The AddressClass bits of _address, a few integer compares for the low system addresses
+    uint8_t classify(std::string_view _address) const
+    {
+        auto low = lowAddress(_address);
+        if (low >= 0)
+        {
+            return (m_builtInLow[low] ? BUILT_IN : NONE) | (m_ethereumLow[low] ? ETHEREUM : NONE);
+        }
+        if (m_namedClasses.empty())
+        {
+            return NONE;
+        }
+        auto it = m_namedClasses.find(std::string(_address));
+        return it != m_namedClasses.end() ? it->second : uint8_t(NONE);
+    }
+
+    // Numeric value of a 40 lowercase hex chars address below LOW_ADDRESS_NUM, -1 otherwise
+    static int32_t lowAddress(std::string_view _address);
+
+    size_t size() const { return m_keys.size(); }
+
+private:
+    // the address padded with zeros, so that keys are compared as fixed-size blocks
+    using Key = std::array<char, MAX_ADDRESS_SIZE>;
+
+    static bool toKey(std::string_view _address, Key& _key);
+    Entry& emplace(std::string_view _address);
+    void setClass(std::string_view _address, AddressClass _class);
+
+    // sorted, m_entries[i] is registered at m_keys[i], a search only touches the keys
+    std::vector<Key> m_keys;
+    std::vector<Entry> m_entries;
+
+    std::bitset<LOW_ADDRESS_NUM> m_builtInLow;
+    std::bitset<LOW_ADDRESS_NUM> m_ethereumLow;
+    // the classes of the other addresses, e.g. the names in WASM mode
+    std::unordered_map<std::string, uint8_t> m_namedClasses;
+};
+
+}  // namespace executor
+}  // namespace bcos
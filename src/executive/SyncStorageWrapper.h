@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Common.h"
+#include "../dag/ReadWriteSet.h"
 #include "bcos-framework/interfaces/storage/StorageInterface.h"
 #include "bcos-framework/interfaces/storage/Table.h"
 #include "bcos-framework/libstorage/StateStorage.h"
@@ -44,6 +45,10 @@ public:
             table, _condition, [&value](auto&& error, auto&& keys) mutable {
                 value = {std::move(error), std::move(keys)};
             });
+        if (m_readSet)
+        {
+            m_readSet->readTable(table);
+        }
 
         // After coroutine switch, set the recoder
         setRecoder(m_recoder);
@@ -62,6 +67,10 @@ public:
         const std::string_view& table, const std::string_view& _key)
     {
         acquireKeyLock(_key);
+        if (m_readSet)
+        {
+            m_readSet->read(table, _key);
+        }
 
         GetRowResponse value;
         m_storage->asyncGetRow(table, _key, [&value](auto&& error, auto&& entry) mutable {
@@ -83,10 +92,14 @@ public:
                                            const gsl::span<std::string const>>& _keys)
     {
         std::visit(
-            [this](auto&& keys) {
+            [this, &table](auto&& keys) {
                 for (auto& it : keys)
                 {
                     acquireKeyLock(it);
+                    if (m_readSet)
+                    {
+                        m_readSet->read(table, it);
+                    }
                 }
             },
             _keys);
@@ -126,6 +139,11 @@ public:
 
     std::optional<storage::Table> createTable(std::string _tableName, std::string _valueFields)
     {
+        if (m_readSet)
+        {
+            // the transaction is never committed optimistically and is executed serially again
+            m_readSet->setUntracked();
+        }
         OpenTableResponse value;
 
         m_storage->asyncCreateTable(std::move(_tableName), std::move(_valueFields),
@@ -145,6 +163,12 @@ public:
 
     std::optional<storage::Table> openTable(std::string_view tableName)
     {
+        if (m_readSet)
+        {
+            // the rows accessed through the table handle are not seen by the wrapper, so the
+            // transaction always falls back to the serial execution
+            m_readSet->setUntracked();
+        }
         OpenTableResponse value;
 
         m_storage->asyncOpenTable(tableName, [&value](auto&& error, auto&& table) mutable {
@@ -166,6 +190,9 @@ public:
         m_storage->setRecoder(std::move(recoder));
     }
 
+    // Record the rows read, used by the optimistic execution to validate the transaction
+    void setReadSet(ReadSet::Ptr readSet) { m_readSet = std::move(readSet); }
+
     void importExistsKeyLocks(gsl::span<std::string> keyLocks)
     {
         m_existsKeyLocks.clear();
@@ -208,6 +235,7 @@ private:
     storage::StateStorage::Ptr m_storage;
     std::function<void(std::string)> m_externalAcquireKeyLocks;
     bcos::storage::StateStorage::Recoder::Ptr m_recoder;
+    ReadSet::Ptr m_readSet;
 
     std::set<std::string, std::less<>> m_existsKeyLocks;
     std::set<std::string, std::less<>> m_myKeyLocks;
@@ -68,9 +68,11 @@ CallParameters::UniquePtr TransactionExecutive::start(CallParameters::UniquePtr
             BOOST_THROW_EXCEPTION(BCOS_ERROR(-1, "blockContext is null"));
         }
 
-        m_storageWrapper = std::make_unique<SyncStorageWrapper>(blockContext->storage(),
+        auto storage = m_speculativeStorage ? m_speculativeStorage : blockContext->storage();
+        m_storageWrapper = std::make_unique<SyncStorageWrapper>(std::move(storage),
             std::bind(&TransactionExecutive::externalAcquireKeyLocks, this, std::placeholders::_1),
             m_recoder);
+        m_storageWrapper->setReadSet(m_readSet);
         if (blockContext->lastStorage())
         {
             m_lastStorageWrapper = std::make_shared<SyncStorageWrapper>(
@@ -321,10 +323,13 @@ std::tuple<std::unique_ptr<HostContext>, CallParameters::UniquePtr> TransactionE
             return {nullptr, std::move(callResults)};
         }
 
-        auto result = m_gasInjector->InjectMeter(code);
+        auto codeHash = blockContext->hashHandler()->hash(code);
+        auto codeHashRef = codeHash.ref();
+        auto result = m_gasInjector->InjectMeter(
+            code, std::string_view((const char*)codeHashRef.data(), codeHashRef.size()));
         if (result.status == wasm::GasInjector::Status::Success)
         {
-            result.byteCode->swap(code);
+            code.assign(result.byteCode->begin(), result.byteCode->end());
         }
         else
         {
@@ -491,9 +496,9 @@ CallParameters::UniquePtr TransactionExecutive::go(
                 vmKind = VMKind::Hera;
             }
 
-            auto vm = VMFactory::create(vmKind);
+            auto vm = VMFactory::acquire(vmKind);
 
-            auto ret = vm.exec(hostContext, mode, &evmcMessage, code.data(), code.size());
+            auto ret = vm->exec(hostContext, mode, &evmcMessage, code.data(), code.size());
 
             auto callResults = hostContext.takeCallParameters();
             // clear unnecessary logs
@@ -576,8 +581,8 @@ CallParameters::UniquePtr TransactionExecutive::go(
         }
         else
         {
-            auto code = hostContext.code();
-            if (code.empty())
+            auto contractCode = hostContext.contractCode();
+            if (!contractCode || contractCode->code.empty())
             {
                 auto callResult = hostContext.takeCallParameters();
                 callResult->type = CallParameters::REVERT;
@@ -586,16 +591,12 @@ CallParameters::UniquePtr TransactionExecutive::go(
                 return callResult;
             }
 
-            auto vmKind = VMKind::evmone;
-            if (hasWasmPreamble(code))
-            {
-                vmKind = VMKind::Hera;
-            }
-            auto vm = VMFactory::create(vmKind);
+            auto vm = VMFactory::acquire(contractCode->kind);
 
             auto mode = toRevision(hostContext.evmSchedule());
             auto evmcMessage = getEVMCMessage(*blockContext, hostContext);
-            auto ret = vm.exec(hostContext, mode, &evmcMessage, code.data(), code.size());
+            auto& code = contractCode->code;
+            auto ret = vm->exec(hostContext, mode, &evmcMessage, code.data(), code.size());
 
             auto callResults = hostContext.takeCallParameters();
             callResults = parseEVMCResult(std::move(callResults), ret);
@@ -736,63 +737,47 @@ std::shared_ptr<precompiled::PrecompiledExecResult> TransactionExecutive::execPr
 
 bool TransactionExecutive::isPrecompiled(const std::string& address) const
 {
-    return m_constantPrecompiled.count(address) > 0;
+    return getPrecompiled(address) != nullptr;
 }
 
 std::shared_ptr<Precompiled> TransactionExecutive::getPrecompiled(const std::string& address) const
 {
-    auto constantPrecompiled = m_constantPrecompiled.find(address);
-
-    if (constantPrecompiled != m_constantPrecompiled.end())
+    if (!m_precompiledRegistry)
     {
-        return constantPrecompiled->second;
+        return {};
     }
-    return {};
+    return m_precompiledRegistry->getPrecompiled(address);
 }
 
 bool TransactionExecutive::isBuiltInPrecompiled(const std::string& _a) const
 {
-    std::stringstream prefix;
-    prefix << std::setfill('0') << std::setw(36);
-    if (_a.find(prefix.str()) != 0)
-        return false;
-    return m_builtInPrecompiled->find(_a) != m_builtInPrecompiled->end();
+    return m_precompiledRegistry->classify(_a) & PrecompiledRegistry::BUILT_IN;
 }
 
 bool TransactionExecutive::isEthereumPrecompiled(const string& _a) const
 {
-    std::stringstream prefix;
-    prefix << std::setfill('0') << std::setw(39);
-    if (_a.find(prefix.str()) != 0)
-        return false;
-    return m_evmPrecompiled->find(_a) != m_evmPrecompiled->end();
+    return m_precompiledRegistry->classify(_a) & PrecompiledRegistry::ETHEREUM;
 }
 
 std::pair<bool, bcos::bytes> TransactionExecutive::executeOriginPrecompiled(
     const string& _a, bytesConstRef _in) const
 {
-    return m_evmPrecompiled->at(_a)->execute(_in);
+    return m_precompiledRegistry->find(_a)->evmPrecompiled->execute(_in);
 }
 
 int64_t TransactionExecutive::costOfPrecompiled(const string& _a, bytesConstRef _in) const
 {
-    return m_evmPrecompiled->at(_a)->cost(_in).convert_to<int64_t>();
+    return m_precompiledRegistry->find(_a)->evmPrecompiled->cost(_in).convert_to<int64_t>();
 }
 
-void TransactionExecutive::setEVMPrecompiled(
-    std::shared_ptr<const std::map<std::string, PrecompiledContract::Ptr>> precompiledContract)
-{
-    m_evmPrecompiled = std::move(precompiledContract);
-}
 void TransactionExecutive::setConstantPrecompiled(
     const string& address, std::shared_ptr<precompiled::Precompiled> precompiled)
 {
-    m_constantPrecompiled.insert(std::make_pair(address, precompiled));
-}
-void TransactionExecutive::setConstantPrecompiled(
-    std::map<std::string, std::shared_ptr<precompiled::Precompiled>> _constantPrecompiled)
-{
-    m_constantPrecompiled = std::move(_constantPrecompiled);
+    auto precompiledRegistry = m_precompiledRegistry ?
+                                   std::make_shared<PrecompiledRegistry>(*m_precompiledRegistry) :
+                                   std::make_shared<PrecompiledRegistry>();
+    precompiledRegistry->setPrecompiled(address, std::move(precompiled));
+    m_precompiledRegistry = std::move(precompiledRegistry);
 }
 
 void TransactionExecutive::revert()
@@ -805,7 +790,8 @@ void TransactionExecutive::revert()
         BOOST_THROW_EXCEPTION(BCOS_ERROR(-1, "blockContext is null!"));
     }
 
-    blockContext->storage()->rollback(*m_recoder);
+    auto storage = m_speculativeStorage ? m_speculativeStorage : blockContext->storage();
+    storage->rollback(*m_recoder);
     m_recoder->clear();
 }
 
@@ -24,6 +24,7 @@
 #include "../Common.h"
 #include "../precompiled/PrecompiledResult.h"
 #include "BlockContext.h"
+#include "PrecompiledRegistry.h"
 #include "SyncStorageWrapper.h"
 #include "bcos-executor/TransactionExecutor.h"
 #include "bcos-framework/interfaces/executor/ExecutionMessage.h"
@@ -121,8 +122,20 @@ public:
 
     std::shared_ptr<SyncStorageWrapper> lastStorage() { return m_lastStorageWrapper; }
 
+    // Execute on a private overlay of the block storage and record the rows read, instead of
+    // writing the block storage directly, call before start()
+    void setSpeculativeStorage(
+        std::shared_ptr<storage::StateStorage> _storage, ReadSet::Ptr _readSet)
+    {
+        m_speculativeStorage = std::move(_storage);
+        m_readSet = std::move(_readSet);
+    }
+
     std::weak_ptr<BlockContext> blockContext() { return m_blockContext; }
 
+    // The writes of the transaction to the storage, undone by rollback() of the storage
+    const bcos::storage::StateStorage::Recoder::Ptr& recoder() const { return m_recoder; }
+
     int64_t contextID() const { return m_contextID; }
     int64_t seq() const { return m_seq; }
 
@@ -139,9 +152,9 @@ public:
     void setConstantPrecompiled(
         const std::string& _address, std::shared_ptr<precompiled::Precompiled> precompiled);
 
-    void setBuiltInPrecompiled(std::shared_ptr<const std::set<std::string>> _builtInPrecompiled)
+    void setPrecompiledRegistry(PrecompiledRegistry::Ptr _precompiledRegistry)
     {
-        m_builtInPrecompiled = std::move(_builtInPrecompiled);
+        m_precompiledRegistry = std::move(_precompiledRegistry);
     }
 
     bool isBuiltInPrecompiled(const std::string& _a) const;
@@ -152,14 +165,6 @@ public:
 
     int64_t costOfPrecompiled(const std::string& _a, bytesConstRef _in) const;
 
-    void setEVMPrecompiled(
-        std::shared_ptr<const std::map<std::string, std::shared_ptr<PrecompiledContract>>>
-            precompiledContract);
-
-    void setConstantPrecompiled(
-        const std::map<std::string, std::shared_ptr<precompiled::Precompiled>>
-            _constantPrecompiled);
-
     std::shared_ptr<precompiled::PrecompiledExecResult> execPrecompiled(const std::string& address,
         bytesConstRef param, const std::string& origin, const std::string& sender);
 
@@ -230,10 +235,8 @@ private:
     bool buildBfsPath(std::string const& _absoluteDir);
 
     std::weak_ptr<BlockContext> m_blockContext;  ///< Information on the runtime environment.
-    std::map<std::string, std::shared_ptr<precompiled::Precompiled>> m_constantPrecompiled;
-    std::shared_ptr<const std::map<std::string, std::shared_ptr<PrecompiledContract>>>
-        m_evmPrecompiled;
-    std::shared_ptr<const std::set<std::string>> m_builtInPrecompiled;
+    // shared by all the executives of an executor, copied on setConstantPrecompiled()
+    PrecompiledRegistry::Ptr m_precompiledRegistry;
 
     std::string m_contractAddress;
     int64_t m_contextID;
@@ -243,6 +246,8 @@ private:
     std::shared_ptr<wasm::GasInjector> m_gasInjector = nullptr;
 
     bcos::storage::StateStorage::Recoder::Ptr m_recoder;
+    std::shared_ptr<storage::StateStorage> m_speculativeStorage;
+    ReadSet::Ptr m_readSet;
     std::unique_ptr<SyncStorageWrapper> m_storageWrapper;
     std::shared_ptr<SyncStorageWrapper> m_lastStorageWrapper;
     CallParameters::UniquePtr m_exchangeMessage = nullptr;
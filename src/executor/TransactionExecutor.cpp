@@ -23,9 +23,12 @@
 #include "../Common.h"
 #include "../dag/Abi.h"
 #include "../dag/ClockCache.h"
+#include "../dag/CriticalExtractor.h"
+#include "../dag/ReadWriteSet.h"
 #include "../dag/ScaleUtils.h"
 #include "../dag/TxDAG.h"
 #include "../executive/BlockContext.h"
+#include "../executive/PrecompiledRegistry.h"
 #include "../executive/TransactionExecutive.h"
 #include "../precompiled/CNSPrecompiled.h"
 #include "../precompiled/Common.h"
@@ -33,6 +36,7 @@
 #include "../precompiled/CryptoPrecompiled.h"
 #include "../precompiled/FileSystemPrecompiled.h"
 #include "../precompiled/KVTableFactoryPrecompiled.h"
+#include "../precompiled/ParallelConfigCache.h"
 #include "../precompiled/ParallelConfigPrecompiled.h"
 #include "../precompiled/PrecompiledResult.h"
 #include "../precompiled/SystemConfigPrecompiled.h"
@@ -55,10 +59,11 @@
 #include "interfaces/protocol/ProtocolTypeDef.h"
 #include "interfaces/storage/StorageInterface.h"
 #include "libprotocol/LogEntry.h"
-#include "tbb/flow_graph.h"
 #include <oneapi/tbb/concurrent_vector.h>
 #include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_pipeline.h>
 #include <tbb/spin_mutex.h>
 #include <boost/algorithm/hex.hpp>
 #include <boost/exception/detail/exception_ptr.hpp>
@@ -68,6 +73,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/thread/latch.hpp>
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 #include <cassert>
 #include <exception>
 #include <functional>
@@ -86,7 +92,9 @@ using namespace bcos::wasm;
 using namespace bcos::protocol;
 using namespace bcos::storage;
 using namespace bcos::precompiled;
-using namespace tbb::flow;
+
+// total charge of the ABI cache, in bytes of the cached FunctionAbi and keys
+static const size_t ABI_CACHE_CAPACITY = 1024 * 1024;
 
 crypto::Hash::Ptr GlobalHashImpl::g_hashImpl;
 
@@ -102,16 +110,17 @@ TransactionExecutor::TransactionExecutor(txpool::TxPoolInterface::Ptr txpool,
     m_hashImpl(std::move(hashImpl)),
     m_isWasm(isWasm),
     m_isAuthCheck(isAuthCheck),
-    m_version(Version_3_0_0)  // current executor version, will set as new block's version
+    // the version this executor was released as, the 3.1.0 features are switched on by the
+    // version of the block header instead, see Version_3_1_0
+    m_version(Version_3_0_0)
 {
     assert(m_backendStorage);
 
     initPrecompiled();
-    assert(m_precompiledContract);
-    assert(m_constantPrecompiled.size() > 0);
-    assert(m_builtInPrecompiled);
+    assert(m_precompiledRegistry && m_precompiledRegistry->size() > 0);
     GlobalHashImpl::g_hashImpl = m_hashImpl;
-    m_abiCache = make_shared<ClockCache<bcos::bytes, FunctionAbi>>(32);
+    m_abiCache = make_shared<ClockCache<bcos::bytes, CachedFunctionAbi>>(ABI_CACHE_CAPACITY);
+    m_parallelConfigCache = make_shared<precompiled::ParallelConfigCache>();
     m_gasInjector = std::make_shared<wasm::GasInjector>(wasm::GetInstructionTable());
 }
 
@@ -159,6 +168,7 @@ void TransactionExecutor::nextBlockHeader(const bcos::protocol::BlockHeader::Con
             }
             // set last commit state storage to blockContext, to auth read last block state
             m_blockContext = createBlockContext(blockHeader, stateStorage, lastStateStorage);
+            m_parallelConfigCache->onBlock(blockHeader->number());
             m_stateStorages.emplace_back(blockHeader->number(), stateStorage);
         }
 
@@ -179,6 +189,10 @@ void TransactionExecutor::dagExecuteTransactions(
         bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
         callback)
 {
+    // a cancellation before the execution of this block is for a former one
+    m_dagCancelled = false;
+    m_dagExecutives.clear();
+
     // for tx hashes fill block
     auto txHashes = std::make_shared<HashList>(inputs.size());
     auto inputMessages =
@@ -238,20 +252,33 @@ void TransactionExecutor::dagExecuteTransactions(
                     return;
                 }
 
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, transactions->size()),
-                    [this, &callParametersList, &inputMessages, &transactions](
-                        const tbb::blocked_range<size_t>& range) {
-                        for (size_t i = range.begin(); i != range.end(); ++i)
+                auto prepare = [this, &callParametersList, &inputMessages, &transactions](
+                                   size_t begin, size_t end) {
+                    for (size_t i = begin; i != end; ++i)
+                    {
+                        if ((*inputMessages)[i])
                         {
                             (*callParametersList)[i] =
                                 createCallParameters(*(*inputMessages)[i], *((*transactions)[i]));
                         }
-                    });
+                    }
+                };
+                if (m_dagPipelineChunkSize > 0)
+                {
+                    pipelineExecuteTransactions(
+                        *callParametersList, *txHashes, std::move(prepare), std::move(callback));
+                    return;
+                }
 
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, transactions->size()),
+                    [&prepare](const tbb::blocked_range<size_t>& range) {
+                        prepare(range.begin(), range.end());
+                    });
 
                 if (m_isWasm)
                 {
-                    dagExecuteTransactionsForWasm(*callParametersList, std::move(callback));
+                    dagExecuteTransactionsForWasm(
+                        *callParametersList, *txHashes, std::move(callback));
                 }
                 else
                 {
@@ -260,11 +287,15 @@ void TransactionExecutor::dagExecuteTransactions(
                 }
             });
     }
+    else if (m_dagPipelineChunkSize > 0)
+    {
+        pipelineExecuteTransactions(*callParametersList, *txHashes, nullptr, std::move(callback));
+    }
     else
     {
         if (m_isWasm)
         {
-            dagExecuteTransactionsForWasm(*callParametersList, std::move(callback));
+            dagExecuteTransactionsForWasm(*callParametersList, *txHashes, std::move(callback));
         }
         else
         {
@@ -278,22 +309,64 @@ void TransactionExecutor::dagExecuteTransactionsForEvm(gsl::span<CallParameters:
     std::function<void(
         bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
         callback)
+{
+    vector<ExecutionMessage::UniquePtr> executionResults(inputs.size());
+    try
+    {
+        std::vector<gsl::index> optimisticIndexes;
+        auto criticals =
+            analyseEvmTransactions(inputs, txHashList, executionResults, optimisticIndexes);
+        executeAnalysedTransactions(inputs, criticals, optimisticIndexes, txHashList,
+            executionResults, dagDeadline(std::chrono::steady_clock::now()));
+    }
+    catch (exception& e)
+    {
+        EXECUTOR_LOG(ERROR) << LOG_BADGE("executeBlock")
+                            << LOG_DESC("Error during parallel block execution")
+                            << LOG_KV("EINFO", boost::diagnostic_information(e));
+        rollbackDAGExecution();
+        callback(BCOS_ERROR_UNIQUE_PTR(ExecuteError::CALL_ERROR, boost::diagnostic_information(e)),
+            vector<ExecutionMessage::UniquePtr>{});
+        return;
+    }
+
+    callback(nullptr, std::move(executionResults));
+}
+
+BlockCriticals TransactionExecutor::analyseEvmTransactions(
+    gsl::span<std::unique_ptr<CallParameters>> inputs,
+    gsl::span<const bcos::crypto::HashType> txHashList,
+    gsl::span<ExecutionMessage::UniquePtr> executionResults,
+    std::vector<gsl::index>& optimisticIndexes)
 {
     auto transactionsNum = inputs.size();
-    vector<ExecutionMessage::UniquePtr> executionResults(transactionsNum);
 
-    // get criticals
-    std::vector<std::vector<std::string>> txsCriticals;
-    txsCriticals.resize(transactionsNum);
-    std::atomic_size_t serialTransactionsNum = 0;
+    // get criticals, the keys of a transaction are appended to the buffer of its thread
+    struct TxKeys
+    {
+        const std::vector<CriticalKey>* buffer = nullptr;
+        uint32_t begin = 0;
+        uint32_t size = 0;
+    };
+    tbb::enumerable_thread_specific<std::vector<CriticalKey>> buffers;
+    std::vector<TxKeys> txsKeys(transactionsNum);
+    std::vector<uint8_t> isOptimistic(transactionsNum, 0);
+    // a chain-level switch, the execution order must be the same on all the nodes
+    auto optimistic = m_blockContext->blockVersion() >= Version_3_1_0;
     tbb::parallel_for(tbb::blocked_range<uint64_t>(0, transactionsNum),
         [&](const tbb::blocked_range<uint64_t>& range) {
+            auto& buffer = buffers.local();
             for (uint64_t i = range.begin(); i < range.end(); i++)
             {
-                txsCriticals[i] = getTxCriticals(*inputs[i]);
-                if (txsCriticals[i].empty())
+                auto begin = buffer.size();
+                getTxCriticals(*inputs[i], buffer);
+                txsKeys[i] = {&buffer, (uint32_t)begin, (uint32_t)(buffer.size() - begin)};
+                if (txsKeys[i].size == 0 && optimistic && !inputs[i]->create)
+                {
+                    isOptimistic[i] = 1;
+                }
+                else if (txsKeys[i].size == 0)
                 {
-                    serialTransactionsNum++;
                     executionResults[i] = toExecutionResult(std::move(inputs[i]));
                     executionResults[i]->setType(ExecutionMessage::SEND_BACK);
                     if (txHashList.size() > i)
@@ -304,16 +377,214 @@ void TransactionExecutor::dagExecuteTransactionsForEvm(gsl::span<CallParameters:
             }
         });
 
-    shared_ptr<TxDAG> txDag = make_shared<TxDAG>();
-    txDag->init(transactionsNum, txsCriticals);
+    BlockCriticals criticals;
+    criticals.offsets.resize(transactionsNum + 1);
+    criticals.offsets[0] = 0;
+    for (size_t i = 0; i < transactionsNum; ++i)
+    {
+        criticals.offsets[i + 1] = criticals.offsets[i] + txsKeys[i].size;
+        if (isOptimistic[i])
+        {
+            optimisticIndexes.push_back(i);
+        }
+    }
+    criticals.keys.resize(criticals.offsets.back());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, transactionsNum),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (auto i = range.begin(); i < range.end(); ++i)
+            {
+                auto& txKeys = txsKeys[i];
+                if (txKeys.size > 0)
+                {
+                    auto begin = txKeys.buffer->begin() + txKeys.begin;
+                    std::copy(begin, begin + txKeys.size,
+                        criticals.keys.begin() + criticals.offsets[i]);
+                }
+            }
+        });
+    return criticals;
+}
+
+void TransactionExecutor::executeAnalysedTransactions(
+    gsl::span<std::unique_ptr<CallParameters>> inputs, const BlockCriticals& criticals,
+    const std::vector<gsl::index>& optimisticIndexes,
+    gsl::span<const bcos::crypto::HashType> txHashList,
+    gsl::span<ExecutionMessage::UniquePtr> executionResults,
+    std::chrono::steady_clock::time_point deadline)
+{
+    // throws if the DAG execution is stopped, so that nothing runs after a partial DAG
+    executeDAG(inputs, criticals, txHashList, executionResults, deadline);
+    if (!optimisticIndexes.empty())
+    {
+        optimisticExecuteTransactions(inputs, optimisticIndexes, txHashList, executionResults);
+    }
+}
+
+std::chrono::steady_clock::time_point TransactionExecutor::dagDeadline(
+    std::chrono::steady_clock::time_point start) const
+{
+    if (m_dagExecutionTimeout.count() > 0)
+    {
+        return start + m_dagExecutionTimeout;
+    }
+    return std::chrono::steady_clock::time_point::max();
+}
+
+void TransactionExecutor::pipelineExecuteTransactions(
+    gsl::span<std::unique_ptr<CallParameters>> inputs, const bcos::crypto::HashList& txHashList,
+    std::function<void(size_t, size_t)> prepare,
+    std::function<void(
+        bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
+        callback)
+{
+    // A chunk of the block, analysed in parallel with the execution of the chunks before it
+    struct Chunk
+    {
+        size_t begin;
+        size_t end;
+        BlockCriticals criticals;
+        std::vector<gsl::index> optimisticIndexes;
+    };
+
+    auto transactionsNum = inputs.size();
+    auto chunkSize = m_dagPipelineChunkSize;
+    vector<ExecutionMessage::UniquePtr> executionResults(transactionsNum);
+    gsl::span<ExecutionMessage::UniquePtr> results(executionResults);
+    gsl::span<const bcos::crypto::HashType> hashes(txHashList);
+    auto chunkHashes = [&hashes](size_t begin, size_t end) {
+        // the hashes may be absent, then the SEND_BACK results have no hash as before
+        if (hashes.size() < end)
+        {
+            return gsl::span<const bcos::crypto::HashType>();
+        }
+        return hashes.subspan(begin, end - begin);
+    };
+
+    auto deadline = dagDeadline(std::chrono::steady_clock::now());
+    size_t next = 0;
+    size_t chunkNum = 0;
+    std::vector<gsl::index> optimisticIndexes;
+    auto startTime = utcSteadyTime();
+    try
+    {
+        tbb::parallel_pipeline(m_DAGThreadNum,
+            tbb::make_filter<void, std::shared_ptr<Chunk>>(tbb::filter_mode::serial_in_order,
+                [&](tbb::flow_control& control) -> std::shared_ptr<Chunk> {
+                    if (next >= transactionsNum)
+                    {
+                        control.stop();
+                        return nullptr;
+                    }
+                    auto chunk = std::make_shared<Chunk>();
+                    chunk->begin = next;
+                    chunk->end = std::min(next + chunkSize, transactionsNum);
+                    next = chunk->end;
+                    ++chunkNum;
+                    return chunk;
+                }) &
+                tbb::make_filter<std::shared_ptr<Chunk>, std::shared_ptr<Chunk>>(
+                    tbb::filter_mode::parallel,
+                    [&](std::shared_ptr<Chunk> chunk) {
+                        if (prepare)
+                        {
+                            prepare(chunk->begin, chunk->end);
+                        }
+                        auto size = chunk->end - chunk->begin;
+                        auto chunkInputs = inputs.subspan(chunk->begin, size);
+                        auto chunkResults = results.subspan(chunk->begin, size);
+                        if (m_isWasm)
+                        {
+                            chunk->criticals = analyseWasmTransactions(
+                                chunkInputs, chunkHashes(chunk->begin, chunk->end), chunkResults);
+                        }
+                        else
+                        {
+                            chunk->criticals = analyseEvmTransactions(chunkInputs,
+                                chunkHashes(chunk->begin, chunk->end), chunkResults,
+                                chunk->optimisticIndexes);
+                        }
+                        return chunk;
+                    }) &
+                tbb::make_filter<std::shared_ptr<Chunk>, void>(tbb::filter_mode::serial_in_order,
+                    [&](std::shared_ptr<Chunk> chunk) {
+                        auto size = chunk->end - chunk->begin;
+                        auto chunkInputs = inputs.subspan(chunk->begin, size);
+                        auto chunkResults = results.subspan(chunk->begin, size);
+                        auto chunkTxHashes = chunkHashes(chunk->begin, chunk->end);
+                        // a cancellation or the deadline fails the block, never a partial result
+                        if (m_dagCancelled || std::chrono::steady_clock::now() >= deadline)
+                        {
+                            BOOST_THROW_EXCEPTION(BCOS_ERROR(ExecuteError::DAG_ERROR,
+                                m_dagCancelled ? "DAG execution cancelled" :
+                                                 "DAG execution timeout"));
+                        }
+                        // the chunks are executed one by one in block order, so every chunk
+                        // sees the state of the chunks before it, the optimistic transactions
+                        // of all the chunks run after the last one, as in a single DAG
+                        executeAnalysedTransactions(chunkInputs, chunk->criticals, {},
+                            chunkTxHashes, chunkResults, deadline);
+                        for (auto index : chunk->optimisticIndexes)
+                        {
+                            optimisticIndexes.push_back(chunk->begin + index);
+                        }
+                    }));
+        if (!optimisticIndexes.empty())
+        {
+            optimisticExecuteTransactions(inputs, optimisticIndexes, hashes, results);
+        }
+    }
+    catch (exception& e)
+    {
+        EXECUTOR_LOG(ERROR) << LOG_BADGE("executeBlock")
+                            << LOG_DESC("Error during pipelined block execution")
+                            << LOG_KV("EINFO", boost::diagnostic_information(e));
+        rollbackDAGExecution();
+        callback(BCOS_ERROR_UNIQUE_PTR(ExecuteError::CALL_ERROR, boost::diagnostic_information(e)),
+            vector<ExecutionMessage::UniquePtr>{});
+        return;
+    }
+
+    EXECUTOR_LOG(DEBUG) << LOG_BADGE("executeBlock") << LOG_DESC("Pipelined execution finished")
+                        << LOG_KV("txNum", transactionsNum) << LOG_KV("chunkNum", chunkNum)
+                        << LOG_KV("elapsed(ms)", utcSteadyTime() - startTime)
+                        << LOG_KV("blockNumber", m_blockContext->number());
+    callback(nullptr, std::move(executionResults));
+}
+
+std::shared_ptr<TxDAG> TransactionExecutor::executeDAG(gsl::span<CallParameters::UniquePtr> inputs,
+    const BlockCriticals& criticals, gsl::span<const bcos::crypto::HashType> txHashList,
+    gsl::span<ExecutionMessage::UniquePtr> executionResults,
+    std::chrono::steady_clock::time_point deadline)
+{
+    auto transactionsNum = inputs.size();
+    assert(criticals.size() == transactionsNum);
+    auto hasCriticals = [&criticals](size_t i) {
+        return criticals.offsets[i + 1] > criticals.offsets[i];
+    };
+
+    shared_ptr<TxDAG> txDag = make_shared<TxDAG>(m_dagSchedulerType, m_DAGThreadNum);
+    if (m_dagSchedulerType == DAGSchedulerType::CriticalPath)
+    {
+        // the calldata size in words is the cost estimate of a transaction
+        std::vector<uint64_t> weights(transactionsNum, 1);
+        for (size_t i = 0; i < transactionsNum; ++i)
+        {
+            if (inputs[i])
+            {
+                weights[i] += inputs[i]->data.size() / 32;
+            }
+        }
+        txDag->setTxWeights(std::move(weights));
+    }
+    txDag->init(criticals);
 
     vector<TransactionExecutive::Ptr> allExecutives(transactionsNum);
     vector<std::unique_ptr<CallParameters>> allCallParameters(transactionsNum);
     std::vector<gsl::index> allIndex(transactionsNum);
 
-    for (gsl::index i = 0; i < transactionsNum; ++i)
+    for (gsl::index i = 0; i < (gsl::index)transactionsNum; ++i)
     {
-        if (txsCriticals[i].empty())
+        if (!hasCriticals(i) || !inputs[i])
         {
             continue;
         }
@@ -324,8 +595,6 @@ void TransactionExecutor::dagExecuteTransactionsForEvm(gsl::span<CallParameters:
 
         auto executive = createExecutive(m_blockContext, input->codeAddress, contextID, seq);
 
-        m_blockContext->insertExecutive(contextID, seq, {executive});
-
         allExecutives[i].swap(executive);
         allCallParameters[i].swap(input);
         allIndex[i] = i;
@@ -334,12 +603,15 @@ void TransactionExecutor::dagExecuteTransactionsForEvm(gsl::span<CallParameters:
     txDag->setTxExecuteFunc(
         [this, &executionResults](bcos::executor::TransactionExecutive::Ptr executive,
             CallParameters::UniquePtr callParameters, gsl::index index) {
-            EXECUTOR_LOG(TRACE) << LOG_BADGE("dagExecuteTransactionsForEvm")
-                                << LOG_DESC("Start transaction")
+            EXECUTOR_LOG(TRACE) << LOG_BADGE("executeDAG") << LOG_DESC("Start transaction")
                                 << LOG_KV("to", callParameters->receiveAddress)
                                 << LOG_KV("data", toHexStringWithPrefix(callParameters->data));
             try
             {
+                // registered when dispatched, a stopped DAG execution fails the whole block
+                m_blockContext->insertExecutive(
+                    callParameters->contextID, callParameters->seq, {executive});
+                m_dagExecutives.push_back(executive);
                 auto output = executive->start(std::move(callParameters));
 
                 executionResults[index] = toExecutionResult(*executive, std::move(output));
@@ -347,62 +619,272 @@ void TransactionExecutor::dagExecuteTransactionsForEvm(gsl::span<CallParameters:
             catch (std::exception& e)
             {
                 EXECUTOR_LOG(ERROR) << "Execute error: " << boost::diagnostic_information(e);
+                executionResults[index] = m_executionMessageFactory->createExecutionMessage();
+                executionResults[index]->setType(ExecutionMessage::REVERT);
+                executionResults[index]->setContextID(executive->contextID());
+                executionResults[index]->setSeq(executive->seq());
             }
         });
 
-    auto parallelTimeOut = utcSteadyTime() + 30000;  // 30 timeout
-    try
+    auto startTime = utcSteadyTime();
+    if (deadline != std::chrono::steady_clock::time_point::max())
+    {
+        txDag->setDeadline(deadline);
+    }
+    {
+        // cancelDAGExecution() sets the flag before it takes the lock, so that it either sees
+        // this DAG or the flag is seen here
+        std::lock_guard<std::mutex> lock(x_runningDAG);
+        m_runningDAG = txDag;
+        if (m_dagCancelled)
+        {
+            txDag->stop();
+        }
+    }
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_DAGThreadNum),
+        [&](const tbb::blocked_range<unsigned int>& _r) {
+            // every range is one worker of the scheduler
+            txDag->run(allExecutives, allCallParameters, allIndex, _r.begin());
+        },
+        tbb::simple_partitioner());
     {
-        std::atomic<bool> isWarnedTimeout(false);
-        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_DAGThreadNum),
-            [&](const tbb::blocked_range<unsigned int>& _r) {
-                (void)_r;
+        std::lock_guard<std::mutex> lock(x_runningDAG);
+        m_runningDAG.reset();
+    }
 
-                while (!txDag->hasFinished())
-                {
-                    if (!isWarnedTimeout.load() && utcSteadyTime() >= parallelTimeOut)
-                    {
-                        isWarnedTimeout.store(true);
-                        EXECUTOR_LOG(WARNING) << LOG_BADGE("executeBlock")
-                                              << LOG_DESC("Para execute block timeout")
-                                              // << LOG_KV("txNum", transactions->size())
-                                              << LOG_KV("blockNumber", m_blockContext->number());
-                    }
-                    txDag->executeUnit(allExecutives, allCallParameters, allIndex);
-                }
+    if (txDag->isStopped())
+    {
+        // Which transactions were dispatched before the stop depends on timing, so that partial
+        // results would make the order of the block differ between the nodes. The block
+        // execution fails instead, and its writes are rolled back by the caller, so that the
+        // block can be executed again.
+        EXECUTOR_LOG(WARNING) << LOG_BADGE("executeBlock")
+                              << LOG_DESC("Para execute block stopped")
+                              << LOG_KV("timeout", txDag->isTimeout())
+                              << LOG_KV("executed", txDag->haveExecuteNumber())
+                              << LOG_KV("blockNumber", m_blockContext->number());
+        BOOST_THROW_EXCEPTION(BCOS_ERROR(ExecuteError::DAG_ERROR,
+            txDag->isTimeout() ? "DAG execution timeout" : "DAG execution cancelled"));
+    }
+
+    auto elapsed = utcSteadyTime() - startTime;
+    if (elapsed >= 30000)
+    {
+        EXECUTOR_LOG(WARNING) << LOG_BADGE("executeBlock") << LOG_DESC("Para execute block slow")
+                              << LOG_KV("elapsed(ms)", elapsed)
+                              << LOG_KV("blockNumber", m_blockContext->number());
+    }
+    auto& workerStatistics = txDag->workerStatistics();
+    for (size_t i = 0; i < workerStatistics.size(); ++i)
+    {
+        auto busy =
+            std::chrono::duration_cast<std::chrono::microseconds>(workerStatistics[i].busy);
+        auto idle =
+            std::chrono::duration_cast<std::chrono::microseconds>(workerStatistics[i].idle);
+        EXECUTOR_LOG(DEBUG) << LOG_BADGE("executeBlock") << LOG_DESC("DAG worker statistics")
+                            << LOG_KV("worker", i)
+                            << LOG_KV("executed", workerStatistics[i].executed)
+                            << LOG_KV("busy(us)", busy.count())
+                            << LOG_KV("idle(us)", idle.count());
+    }
+    return txDag;
+}
+
+void TransactionExecutor::rollbackDAGExecution()
+{
+    if (m_dagExecutives.empty())
+    {
+        return;
+    }
+    // a transaction is dispatched after the ones it depends on, so that the writes are undone in
+    // the reverse order of the dispatching
+    auto storage = m_blockContext->storage();
+    for (auto i = m_dagExecutives.size(); i > 0; --i)
+    {
+        auto& executive = m_dagExecutives[i - 1];
+        storage->rollback(*executive->recoder());
+        executive->recoder()->clear();
+        m_blockContext->eraseExecutive(executive->contextID(), executive->seq());
+    }
+    EXECUTOR_LOG(INFO) << LOG_BADGE("executeBlock") << LOG_DESC("DAG execution rolled back")
+                       << LOG_KV("executed", m_dagExecutives.size())
+                       << LOG_KV("blockNumber", m_blockContext->number());
+    m_dagExecutives.clear();
+}
+
+void TransactionExecutor::cancelDAGExecution()
+{
+    m_dagCancelled = true;
+    std::lock_guard<std::mutex> lock(x_runningDAG);
+    auto txDag = m_runningDAG.lock();
+    if (txDag)
+    {
+        txDag->stop();
+    }
+}
+
+void TransactionExecutor::optimisticExecuteTransactions(
+    gsl::span<std::unique_ptr<CallParameters>> inputs, const std::vector<gsl::index>& indexes,
+    gsl::span<const bcos::crypto::HashType> txHashList,
+    gsl::span<ExecutionMessage::UniquePtr> executionResults)
+{
+    // One execution of a transaction on its own overlay of the block storage
+    struct Speculation
+    {
+        StateStorage::Ptr storage;
+        ReadSet::Ptr readSet;
+        // null if the transaction calls another contract or fails, it is sent back then
+        ExecutionMessage::UniquePtr result;
+    };
+
+    auto speculate = [this](const CallParameters& _input, Speculation& _speculation) {
+        // the input is kept for the re-execution and the sending back
+        auto callParameters = std::make_unique<CallParameters>(_input.type);
+        callParameters->contextID = _input.contextID;
+        callParameters->seq = _input.seq;
+        callParameters->senderAddress = _input.senderAddress;
+        callParameters->codeAddress = _input.codeAddress;
+        callParameters->receiveAddress = _input.receiveAddress;
+        callParameters->origin = _input.origin;
+        callParameters->gas = _input.gas;
+        callParameters->data = _input.data;
+        callParameters->staticCall = _input.staticCall;
+        callParameters->create = _input.create;
+
+        _speculation.storage = std::make_shared<StateStorage>(m_blockContext->storage());
+        _speculation.readSet = std::make_shared<ReadSet>();
+        _speculation.result = nullptr;
+        try
+        {
+            // not registered in the block context, a transaction sent back is executed again
+            // from scratch
+            auto executive = createExecutive(m_blockContext, callParameters->codeAddress,
+                callParameters->contextID, callParameters->seq);
+            executive->setSpeculativeStorage(_speculation.storage, _speculation.readSet);
+            auto output = executive->start(std::move(callParameters));
+            if (output->type == CallParameters::FINISHED || output->type == CallParameters::REVERT)
+            {
+                _speculation.result = toExecutionResult(*executive, std::move(output));
+            }
+        }
+        catch (std::exception& e)
+        {
+            EXECUTOR_LOG(ERROR) << "Optimistic execute error: " << boost::diagnostic_information(e);
+        }
+    };
+
+    auto sendBack = [&](gsl::index _index) {
+        executionResults[_index] = toExecutionResult(std::move(inputs[_index]));
+        executionResults[_index]->setType(ExecutionMessage::SEND_BACK);
+        if (txHashList.size() > (size_t)_index)
+        {
+            executionResults[_index]->setTransactionHash(txHashList[_index]);
+        }
+    };
+
+    // The SEND_BACK transactions are executed one after another after the DAG, so only the
+    // transactions before the first of them can be committed here, the order is the same as
+    // without optimistic execution then
+    auto firstSendBack = std::find_if(executionResults.begin(), executionResults.end(),
+        [](const ExecutionMessage::UniquePtr& _result) {
+            return _result && _result->type() == ExecutionMessage::SEND_BACK;
+        });
+    auto prefixNum = (size_t)(std::lower_bound(indexes.begin(), indexes.end(),
+                                  (gsl::index)(firstSendBack - executionResults.begin())) -
+                              indexes.begin());
+
+    // Every transaction runs on the state after the DAG transactions
+    std::vector<Speculation> speculations(prefixNum);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, prefixNum),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (auto i = range.begin(); i != range.end(); ++i)
+            {
+                speculate(*inputs[indexes[i]], speculations[i]);
+            }
+        });
+
+    // Validate and commit in block order, a transaction which read a row written by a committed
+    // one is executed again on the committed state, which is serial but rare. The transactions
+    // from the first one without result on are sent back, for the same reason as above.
+    WriteSet committed;
+    std::mutex writeMutex;
+    size_t reexecuteNum = 0;
+    size_t i = 0;
+    for (; i < prefixNum; ++i)
+    {
+        auto index = indexes[i];
+        auto& speculation = speculations[i];
+        if (speculation.result && committed.conflicts(*speculation.readSet))
+        {
+            speculate(*inputs[index], speculation);
+            ++reexecuteNum;
+        }
+
+        if (!speculation.result)
+        {
+            break;
+        }
+
+        speculation.storage->parallelTraverse(true,
+            [&](const std::string_view& table, const std::string_view& key, const Entry&) {
+                std::lock_guard<std::mutex> lock(writeMutex);
+                committed.write(table, key);
+                return true;
             });
+        m_blockContext->storage()->merge(true, *speculation.storage);
+        executionResults[index] = std::move(speculation.result);
+        speculation.storage.reset();
+    }
+    auto sendBackNum = indexes.size() - i;
+    for (; i < indexes.size(); ++i)
+    {
+        sendBack(indexes[i]);
+    }
+
+    EXECUTOR_LOG(DEBUG) << LOG_BADGE("executeBlock") << LOG_DESC("Optimistic execution finished")
+                        << LOG_KV("txNum", indexes.size()) << LOG_KV("reexecute", reexecuteNum)
+                        << LOG_KV("sendBack", sendBackNum)
+                        << LOG_KV("blockNumber", m_blockContext->number());
+}
+
+void TransactionExecutor::dagExecuteTransactionsForWasm(
+    gsl::span<std::unique_ptr<CallParameters>> inputs, const bcos::crypto::HashList& txHashList,
+    std::function<void(
+        bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
+        callback)
+{
+    vector<ExecutionMessage::UniquePtr> executionResults(inputs.size());
+    try
+    {
+        auto criticals = analyseWasmTransactions(inputs, txHashList, executionResults);
+        executeAnalysedTransactions(inputs, criticals, {}, txHashList, executionResults,
+            dagDeadline(std::chrono::steady_clock::now()));
     }
     catch (exception& e)
     {
         EXECUTOR_LOG(ERROR) << LOG_BADGE("executeBlock")
                             << LOG_DESC("Error during parallel block execution")
                             << LOG_KV("EINFO", boost::diagnostic_information(e));
+        rollbackDAGExecution();
         callback(BCOS_ERROR_UNIQUE_PTR(ExecuteError::CALL_ERROR, boost::diagnostic_information(e)),
             vector<ExecutionMessage::UniquePtr>{});
         return;
     }
-
     callback(nullptr, std::move(executionResults));
 }
 
-void TransactionExecutor::dagExecuteTransactionsForWasm(
+BlockCriticals TransactionExecutor::analyseWasmTransactions(
     gsl::span<std::unique_ptr<CallParameters>> inputs,
-    std::function<void(
-        bcos::Error::UniquePtr, std::vector<bcos::protocol::ExecutionMessage::UniquePtr>)>
-        callback)
+    gsl::span<const bcos::crypto::HashType> txHashList,
+    gsl::span<ExecutionMessage::UniquePtr> executionResults)
 {
     auto transactionsNum = inputs.size();
-    auto executionResults = vector<ExecutionMessage::UniquePtr>(transactionsNum);
     auto allConflictFields = vector<optional<ConflictFields>>(transactionsNum, nullopt);
 
-    mutex tableMutex;
     tbb::parallel_for(tbb::blocked_range<uint64_t>(0, transactionsNum),
         [&](const tbb::blocked_range<uint64_t>& range) {
             for (auto i = range.begin(); i != range.end(); ++i)
             {
-                auto defaultExecutionResult = m_executionMessageFactory->createExecutionMessage();
-                executionResults[i].swap(defaultExecutionResult);
-
                 const auto& params = inputs[i];
 
                 const auto& to = params->receiveAddress;
@@ -412,6 +894,10 @@ void TransactionExecutor::dagExecuteTransactionsForWasm(
                 {
                     executionResults[i] = toExecutionResult(std::move(inputs[i]));
                     executionResults[i]->setType(ExecutionMessage::SEND_BACK);
+                    if (txHashList.size() > i)
+                    {
+                        executionResults[i]->setTransactionHash(txHashList[i]);
+                    }
                     continue;
                 }
 
@@ -419,72 +905,49 @@ void TransactionExecutor::dagExecuteTransactionsForWasm(
                 auto abiKey = bytes(to.cbegin(), to.cend());
                 abiKey.insert(abiKey.end(), selector.begin(), selector.end());
 
-                auto cacheHandle = m_abiCache->lookup(abiKey);
-                optional<ConflictFields> conflictFields = nullopt;
-                if (!cacheHandle.isValid())
-                {
-                    EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                        << LOG_DESC("No ABI found in cache, try to load")
-                                        << LOG_KV("abiKey", toHexStringWithPrefix(abiKey));
-
-                    std::lock_guard guard(tableMutex);
-
-                    cacheHandle = m_abiCache->lookup(abiKey);
-                    if (cacheHandle.isValid())
-                    {
+                // misses of different contracts load in parallel, of the same ABI load once
+                auto cacheHandle = m_abiCache->getOrLoad(
+                    abiKey,
+                    [&]() {
                         EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                            << LOG_DESC("ABI had beed loaded by other workers")
+                                            << LOG_DESC("No ABI found in cache, try to load")
                                             << LOG_KV("abiKey", toHexStringWithPrefix(abiKey));
-                        auto& functionAbi = cacheHandle.value();
-                        conflictFields = decodeConflictFields(functionAbi, *params);
-                    }
-                    else
-                    {
                         auto storage = m_blockContext->storage();
                         auto tableName = "/apps" + string(to);
                         auto table = storage->openTable(tableName);
-                        assert(table.has_value());
-
-                        auto entry = table->getRow(ACCOUNT_ABI);
+                        auto entry = table ? table->getRow(ACCOUNT_ABI) : std::nullopt;
+                        if (!entry)
+                        {
+                            // not cached, the contract may be deployed by a later block
+                            EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
+                                                << LOG_DESC("No ABI found")
+                                                << LOG_KV("abiKey", toHexStringWithPrefix(abiKey));
+                            return std::unique_ptr<CachedFunctionAbi>();
+                        }
                         auto abiStr = entry->getField(0);
-
                         EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
                                             << LOG_DESC("ABI loaded") << LOG_KV("ABI", abiStr);
-
-                        auto functionAbi =
+                        auto cached = std::make_unique<CachedFunctionAbi>();
+                        // null if the stored ABI is invalid, cached as a negative entry so that
+                        // the contract costs no table read and parse for each of its transactions
+                        cached->abi =
                             FunctionAbi::deserialize(abiStr, selector.toBytes(), m_hashImpl);
-                        if (!functionAbi)
-                        {
-                            executionResults[i] = toExecutionResult(std::move(inputs[i]));
-                            executionResults[i]->setType(ExecutionMessage::SEND_BACK);
-                            // If abi is not valid, we don't impact the cache. In such a
-                            // situation, if the caller invokes this method over and over
-                            // again, executor will read the contract table repeatedly,
-                            // which may cause performance loss. But we think occurrence
-                            // of invalid abi is impossible in actual situations.
-                            continue;
-                        }
-
-                        auto abiPtr = functionAbi.get();
-                        if (m_abiCache->insert(abiKey, abiPtr, &cacheHandle))
-                        {
-                            // If abi object had been inserted into the cache successfully,
-                            // the cache will take charge of life time management of the
-                            // object. After this object being eliminated, the cache will
-                            // delete its memory storage.
-                            std::ignore = functionAbi.release();
-                        }
-                        conflictFields = decodeConflictFields(*abiPtr, *params);
-                    }
-                }
-                else
+                        return cached;
+                    },
+                    [&](const CachedFunctionAbi& cached) {
+                        return abiKey.size() + cached.memorySize();
+                    });
+                if (!cacheHandle.isValid() || !cacheHandle.value().abi)
                 {
-                    EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                        << LOG_DESC("Found ABI in cache")
-                                        << LOG_KV("abiKey", toHexStringWithPrefix(abiKey));
-                    auto& functionAbi = cacheHandle.value();
-                    conflictFields = decodeConflictFields(functionAbi, *params);
+                    executionResults[i] = toExecutionResult(std::move(inputs[i]));
+                    executionResults[i]->setType(ExecutionMessage::SEND_BACK);
+                    if (txHashList.size() > i)
+                    {
+                        executionResults[i]->setTransactionHash(txHashList[i]);
+                    }
+                    continue;
                 }
+                auto conflictFields = decodeConflictFields(*cacheHandle.value().abi, *params);
 
                 if (!conflictFields.has_value())
                 {
@@ -492,135 +955,54 @@ void TransactionExecutor::dagExecuteTransactionsForWasm(
                         << LOG_BADGE("dagExecuteTransactionsForWasm")
                         << LOG_DESC("The transaction can't be executed concurrently")
                         << LOG_KV("abiKey", toHexStringWithPrefix(abiKey));
+                    executionResults[i] = toExecutionResult(std::move(inputs[i]));
                     executionResults[i]->setType(ExecutionMessage::SEND_BACK);
+                    if (txHashList.size() > i)
+                    {
+                        executionResults[i]->setTransactionHash(txHashList[i]);
+                    }
                     continue;
                 }
                 allConflictFields[i] = std::move(conflictFields);
             }
         });
 
-    using Task = continue_node<continue_msg>;
-    using Msg = const continue_msg&;
-
-    auto tasks = vector<Task>();
-    tasks.reserve(transactionsNum);
-    auto flowGraph = graph();
-    broadcast_node<continue_msg> start(flowGraph);
-
-    auto dependencies = unordered_map<bytes, vector<size_t>, boost::hash<bytes>>();
-    auto slotUsage = unordered_map<size_t, size_t>();
-
-    for (auto i = 0u; i < allConflictFields.size(); ++i)
+    auto abiCacheStats = m_abiCache->stats();
+    EXECUTOR_LOG(DEBUG) << LOG_BADGE("analyseWasmTransactions") << LOG_DESC("ABI cache")
+                        << LOG_KV("hits", abiCacheStats.hits)
+                        << LOG_KV("misses", abiCacheStats.misses)
+                        << LOG_KV("evictions", abiCacheStats.evictions)
+                        << LOG_KV("usage", abiCacheStats.usage)
+                        << LOG_KV("capacity", abiCacheStats.capacity);
+
+    // A conflict field of a whole slot(All or Len) is exclusive on the slot, a field of one key
+    // is exclusive on the key and shared on its slot, so that it conflicts with the whole slot
+    // users but not with the other keys of the slot
+    BlockCriticals criticals;
+    std::vector<CriticalKey> keys;
+    std::vector<CriticalKey> sharedKeys;
+    for (size_t i = 0; i < transactionsNum; ++i)
     {
-        auto& conflictFields = allConflictFields[i];
-        if (!conflictFields.has_value())
+        keys.clear();
+        sharedKeys.clear();
+        if (allConflictFields[i].has_value())
         {
-            // Transactions those invokes method which can't be executed concurrently
-            // will be sent back.
-            continue;
-        }
-
-        auto& input = inputs[i];
-        auto contextID = input->contextID;
-        auto seq = input->seq;
-
-        auto executive = createExecutive(m_blockContext, input->receiveAddress, contextID, seq);
-        m_blockContext->insertExecutive(contextID, seq, {executive});
-
-        auto task = [this, i, executive, &inputs, &executionResults](Msg) {
-            EXECUTOR_LOG(TRACE) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                << LOG_DESC("Start transaction")
-                                << LOG_KV("to", inputs[i]->receiveAddress) << LOG_KV("contextID", i)
-                                << LOG_KV("seq", 0);
-            try
-            {
-                auto output = executive->start(std::move(inputs[i]));
-                executionResults[i] = toExecutionResult(*executive, std::move(output));
-            }
-            catch (std::exception& e)
-            {
-                EXECUTOR_LOG(ERROR) << "Execute error: " << boost::diagnostic_information(e);
-                executionResults[i]->setType(ExecutionMessage::REVERT);
-            }
-        };
-        auto index = tasks.size();
-        auto t = Task(flowGraph, std::move(task));
-        tasks.push_back(t);
-
-        auto noDeps = true;
-        for (auto& conflictField : conflictFields.value())
-        {
-            assert(conflictField.size() >= sizeof(size_t));
-
-            auto slot = *(size_t*)conflictField.data();
-            auto iter = slotUsage.find(slot);
-            if (iter != slotUsage.end() && iter->second != index)
-            {
-                noDeps = false;
-                make_edge(tasks[iter->second], tasks[index]);
-
-                EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                    << LOG_DESC("Make dependency for slot")
-                                    << LOG_KV("from", iter->second) << LOG_KV("to", index);
-            }
-
-            if (conflictField.size() != sizeof(size_t))
-            {
-                auto iter = dependencies.find(conflictField);
-                if (iter != dependencies.end() && iter->second.back() != index)
-                {
-                    noDeps = false;
-                    make_edge(tasks[iter->second.back()], tasks[index]);
-
-                    EXECUTOR_LOG(DEBUG)
-                        << LOG_BADGE("dagExecuteTransactionsForWasm")
-                        << LOG_DESC("Make dependency for key")
-                        << LOG_KV("from", iter->second.back()) << LOG_KV("to", index);
-                    dependencies[conflictField].push_back(index);
-                }
-                else
-                {
-                    dependencies[conflictField] = {index};
-                }
-            }
-            else
+            for (auto& conflictField : allConflictFields[i].value())
             {
-                // `slotUsage` is used when some a conflict key equals to `All` or `Len`. In such
-                // cases, if there are 2 transations and one of them uses all of slot 0  meanwhile
-                // another use a key to visit slot 0, then their conflict keys may looks very
-                // different, and they can't be captured by `dependencies` only.
-                for (auto& slotIndices : dependencies)
+                assert(conflictField.size() >= sizeof(size_t));
+                keys.push_back(CriticalKey::hash(
+                    std::string_view((const char*)conflictField.data(), conflictField.size())));
+                if (conflictField.size() != sizeof(size_t))
                 {
-                    auto prevSlot = *(size_t*)slotIndices.first.data();
-                    if (prevSlot == slot)
-                    {
-                        auto& prevIndices = slotIndices.second;
-                        if (prevIndices.size() != 0)
-                        {
-                            noDeps = false;
-                        }
-                        for (auto prevIndex : prevIndices)
-                        {
-                            make_edge(tasks[prevIndex], tasks[index]);
-                        }
-                    }
+                    sharedKeys.push_back(CriticalKey::hash(
+                        std::string_view((const char*)conflictField.data(), sizeof(size_t))));
                 }
-                slotUsage[slot] = index;
             }
         }
-
-        if (noDeps)
-        {
-            make_edge(start, tasks[index]);
-            EXECUTOR_LOG(DEBUG) << LOG_BADGE("dagExecuteTransactionsForWasm")
-                                << LOG_DESC("Make dependency for start") << LOG_KV("from", "start")
-                                << LOG_KV("to", index);
-        }
+        criticals.append(keys, sharedKeys);
     }
 
-    start.try_put(continue_msg());
-    flowGraph.wait_for_all();
-    callback(nullptr, std::move(executionResults));
+    return criticals;
 }
 
 void TransactionExecutor::call(bcos::protocol::ExecutionMessage::UniquePtr input,
@@ -930,6 +1312,8 @@ void TransactionExecutor::rollback(
         return;
     }
 
+    m_parallelConfigCache->clear();
+    m_abiCache->clear();
     bcos::storage::TransactionalStorageInterface::TwoPCParams storageParams;
     storageParams.number = params.number;
     m_backendStorage->asyncRollback(storageParams, [callback = std::move(callback)](auto&& error) {
@@ -950,6 +1334,8 @@ void TransactionExecutor::rollback(
 void TransactionExecutor::reset(std::function<void(bcos::Error::Ptr)> callback)
 {
     m_stateStorages.clear();
+    m_parallelConfigCache->clear();
+    m_abiCache->clear();
 
     callback(nullptr);
 }
@@ -1393,6 +1779,7 @@ BlockContext::Ptr TransactionExecutor::createBlockContext(
 {
     BlockContext::Ptr context = make_shared<BlockContext>(storage, lastStorage, m_hashImpl,
         currentHeader, FiscoBcosScheduleV3, m_isWasm, m_isAuthCheck);
+    context->setParallelConfigCache(m_parallelConfigCache);
 
     return context;
 }
@@ -1413,9 +1800,7 @@ TransactionExecutive::Ptr TransactionExecutor::createExecutive(
 {
     auto executive = std::make_shared<TransactionExecutive>(
         _blockContext, _contractAddress, contextID, seq, m_gasInjector);
-    executive->setConstantPrecompiled(m_constantPrecompiled);
-    executive->setEVMPrecompiled(m_precompiledContract);
-    executive->setBuiltInPrecompiled(m_builtInPrecompiled);
+    executive->setPrecompiledRegistry(m_precompiledRegistry);
 
     // TODO: register User developed Precompiled contract
     // registerUserPrecompiled(context);
@@ -1429,37 +1814,36 @@ void TransactionExecutor::initPrecompiled()
         stream << std::setfill('0') << std::setw(40) << std::hex << _num;
         return stream.str();
     };
-    m_precompiledContract =
-        std::make_shared<std::map<std::string, std::shared_ptr<PrecompiledContract>>>();
-    m_builtInPrecompiled = std::make_shared<std::set<std::string>>();
-
-    m_precompiledContract->insert(std::make_pair(fillZero(1),
-        make_shared<PrecompiledContract>(3000, 0, PrecompiledRegistrar::executor("ecrecover"))));
-    m_precompiledContract->insert(std::make_pair(fillZero(2),
-        make_shared<PrecompiledContract>(60, 12, PrecompiledRegistrar::executor("sha256"))));
-    m_precompiledContract->insert(std::make_pair(fillZero(3),
-        make_shared<PrecompiledContract>(600, 120, PrecompiledRegistrar::executor("ripemd160"))));
-    m_precompiledContract->insert(std::make_pair(fillZero(4),
-        make_shared<PrecompiledContract>(15, 3, PrecompiledRegistrar::executor("identity"))));
-    m_precompiledContract->insert(
-        {fillZero(5), make_shared<PrecompiledContract>(PrecompiledRegistrar::pricer("modexp"),
-                          PrecompiledRegistrar::executor("modexp"))});
-    m_precompiledContract->insert(
-        {fillZero(6), make_shared<PrecompiledContract>(
-                          150, 0, PrecompiledRegistrar::executor("alt_bn128_G1_add"))});
-    m_precompiledContract->insert(
-        {fillZero(7), make_shared<PrecompiledContract>(
-                          6000, 0, PrecompiledRegistrar::executor("alt_bn128_G1_mul"))});
-    m_precompiledContract->insert({fillZero(8),
+    auto precompiledRegistry = std::make_shared<PrecompiledRegistry>();
+
+    precompiledRegistry->setEVMPrecompiled(fillZero(1),
+        make_shared<PrecompiledContract>(3000, 0, PrecompiledRegistrar::executor("ecrecover")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(2),
+        make_shared<PrecompiledContract>(60, 12, PrecompiledRegistrar::executor("sha256")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(3),
+        make_shared<PrecompiledContract>(600, 120, PrecompiledRegistrar::executor("ripemd160")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(4),
+        make_shared<PrecompiledContract>(15, 3, PrecompiledRegistrar::executor("identity")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(5),
+        make_shared<PrecompiledContract>(
+            PrecompiledRegistrar::pricer("modexp"), PrecompiledRegistrar::executor("modexp")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(6),
+        make_shared<PrecompiledContract>(
+            150, 0, PrecompiledRegistrar::executor("alt_bn128_G1_add")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(7),
+        make_shared<PrecompiledContract>(
+            6000, 0, PrecompiledRegistrar::executor("alt_bn128_G1_mul")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(8),
         make_shared<PrecompiledContract>(PrecompiledRegistrar::pricer("alt_bn128_pairing_product"),
-            PrecompiledRegistrar::executor("alt_bn128_pairing_product"))});
-    m_precompiledContract->insert({fillZero(9),
+            PrecompiledRegistrar::executor("alt_bn128_pairing_product")));
+    precompiledRegistry->setEVMPrecompiled(fillZero(9),
         make_shared<PrecompiledContract>(PrecompiledRegistrar::pricer("blake2_compression"),
-            PrecompiledRegistrar::executor("blake2_compression"))});
+            PrecompiledRegistrar::executor("blake2_compression")));
 
     auto sysConfig = std::make_shared<precompiled::SystemConfigPrecompiled>(m_hashImpl);
     auto parallelConfigPrecompiled =
         std::make_shared<precompiled::ParallelConfigPrecompiled>(m_hashImpl);
+    m_parallelConfigPrecompiled = parallelConfigPrecompiled;
     auto consensusPrecompiled = std::make_shared<precompiled::ConsensusPrecompiled>(m_hashImpl);
     auto cnsPrecompiled = std::make_shared<precompiled::CNSPrecompiled>(m_hashImpl);
     // FIXME: not support crud now
@@ -1470,45 +1854,44 @@ void TransactionExecutor::initPrecompiled()
 
     if (m_isWasm)
     {
-        m_constantPrecompiled.insert({SYS_CONFIG_NAME, sysConfig});
-        m_constantPrecompiled.insert({CONSENSUS_NAME, consensusPrecompiled});
-        m_constantPrecompiled.insert({CNS_NAME, cnsPrecompiled});
-        m_constantPrecompiled.insert({PARALLEL_CONFIG_NAME, parallelConfigPrecompiled});
+        precompiledRegistry->setPrecompiled(SYS_CONFIG_NAME, sysConfig);
+        precompiledRegistry->setPrecompiled(CONSENSUS_NAME, consensusPrecompiled);
+        precompiledRegistry->setPrecompiled(CNS_NAME, cnsPrecompiled);
+        precompiledRegistry->setPrecompiled(PARALLEL_CONFIG_NAME, parallelConfigPrecompiled);
         // FIXME: not support crud now
-        // m_constantPrecompiled.insert({TABLE_NAME, tableFactoryPrecompiled});
-        m_constantPrecompiled.insert({KV_TABLE_NAME, kvTableFactoryPrecompiled});
-        m_constantPrecompiled.insert(
-            {DAG_TRANSFER_NAME, std::make_shared<precompiled::DagTransferPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert(
-            {CRYPTO_NAME, std::make_shared<CryptoPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert(
-            {BFS_NAME, std::make_shared<precompiled::FileSystemPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert({CONTRACT_AUTH_NAME,
-            std::make_shared<precompiled::ContractAuthPrecompiled>(m_hashImpl)});
-
-        set<string> builtIn = {CRYPTO_NAME};
-        m_builtInPrecompiled = make_shared<set<string>>(builtIn);
+        // precompiledRegistry->setPrecompiled(TABLE_NAME, tableFactoryPrecompiled);
+        precompiledRegistry->setPrecompiled(KV_TABLE_NAME, kvTableFactoryPrecompiled);
+        precompiledRegistry->setPrecompiled(
+            DAG_TRANSFER_NAME, std::make_shared<precompiled::DagTransferPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(
+            CRYPTO_NAME, std::make_shared<CryptoPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(
+            BFS_NAME, std::make_shared<precompiled::FileSystemPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(CONTRACT_AUTH_NAME,
+            std::make_shared<precompiled::ContractAuthPrecompiled>(m_hashImpl));
+
+        precompiledRegistry->setBuiltIn(CRYPTO_NAME);
     }
     else
     {
-        m_constantPrecompiled.insert({SYS_CONFIG_ADDRESS, sysConfig});
-        m_constantPrecompiled.insert({CONSENSUS_ADDRESS, consensusPrecompiled});
-        m_constantPrecompiled.insert({CNS_ADDRESS, cnsPrecompiled});
-        m_constantPrecompiled.insert({PARALLEL_CONFIG_ADDRESS, parallelConfigPrecompiled});
+        precompiledRegistry->setPrecompiled(SYS_CONFIG_ADDRESS, sysConfig);
+        precompiledRegistry->setPrecompiled(CONSENSUS_ADDRESS, consensusPrecompiled);
+        precompiledRegistry->setPrecompiled(CNS_ADDRESS, cnsPrecompiled);
+        precompiledRegistry->setPrecompiled(PARALLEL_CONFIG_ADDRESS, parallelConfigPrecompiled);
         // FIXME: not support crud now
-        // m_constantPrecompiled.insert({TABLE_ADDRESS, tableFactoryPrecompiled});
-        m_constantPrecompiled.insert({KV_TABLE_ADDRESS, kvTableFactoryPrecompiled});
-        m_constantPrecompiled.insert({DAG_TRANSFER_ADDRESS,
-            std::make_shared<precompiled::DagTransferPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert(
-            {CRYPTO_ADDRESS, std::make_shared<CryptoPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert(
-            {BFS_ADDRESS, std::make_shared<precompiled::FileSystemPrecompiled>(m_hashImpl)});
-        m_constantPrecompiled.insert({CONTRACT_AUTH_ADDRESS,
-            std::make_shared<precompiled::ContractAuthPrecompiled>(m_hashImpl)});
-        set<string> builtIn = {CRYPTO_ADDRESS};
-        m_builtInPrecompiled = make_shared<set<string>>(builtIn);
+        // precompiledRegistry->setPrecompiled(TABLE_ADDRESS, tableFactoryPrecompiled);
+        precompiledRegistry->setPrecompiled(KV_TABLE_ADDRESS, kvTableFactoryPrecompiled);
+        precompiledRegistry->setPrecompiled(DAG_TRANSFER_ADDRESS,
+            std::make_shared<precompiled::DagTransferPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(
+            CRYPTO_ADDRESS, std::make_shared<CryptoPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(
+            BFS_ADDRESS, std::make_shared<precompiled::FileSystemPrecompiled>(m_hashImpl));
+        precompiledRegistry->setPrecompiled(CONTRACT_AUTH_ADDRESS,
+            std::make_shared<precompiled::ContractAuthPrecompiled>(m_hashImpl));
+        precompiledRegistry->setBuiltIn(CRYPTO_ADDRESS);
     }
+    m_precompiledRegistry = std::move(precompiledRegistry);
 }
 
 void TransactionExecutor::removeCommittedState()
@@ -1636,93 +2019,125 @@ std::unique_ptr<CallParameters> TransactionExecutor::createCallParameters(
     return callParameters;
 }
 
-std::vector<std::string> TransactionExecutor::getTxCriticals(const CallParameters& params)
+std::shared_ptr<precompiled::Precompiled> TransactionExecutor::getPrecompiled(
+    const std::string& address) const
+{
+    return m_precompiledRegistry->getPrecompiled(address);
+}
+
+void TransactionExecutor::getTxCriticals(
+    const CallParameters& params, std::vector<CriticalKey>& criticals)
 {
     if (params.create)
     {
         // Not to parallel contract creation transaction
-        return {};
+        return;
     }
 
-    // temp executive
-    auto executive = createExecutive(m_blockContext, std::string(params.receiveAddress), 0, 0);
-    auto p = executive->getPrecompiled(params.receiveAddress);
+    // the blocks before Version_3_1_0 key the decoded criticals suffixed by the address, the
+    // DAG and so the order of their transactions must not change
+    auto decoded = m_blockContext->blockVersion() < Version_3_1_0;
+    // the criticals of different contracts never conflict
+    auto scope = CriticalKey::hash(params.receiveAddress);
+    auto p = getPrecompiled(params.receiveAddress);
     if (p)
     {
         // Precompile transaction
         if (p->isParallelPrecompiled())
         {
-            auto ret = vector<string>(p->getParallelTag(ref(params.data), m_isWasm));
-            for (string& critical : ret)
+            for (auto& critical : p->getParallelTag(ref(params.data), m_isWasm))
             {
-                critical += params.receiveAddress;
+                criticals.push_back(decoded ? CriticalKey::hash(critical + params.receiveAddress) :
+                                              CriticalKey::hash(critical, scope));
             }
-            return ret;
         }
-        return {};
+        return;
     }
     uint32_t selector = precompiled::getParamFunc(ref(params.data));
 
-    auto receiveAddress = params.receiveAddress;
-    std::shared_ptr<precompiled::ParallelConfig> config = nullptr;
-    // hit the cache, fetch ParallelConfig from the cache directly
     // Note: Only when initializing DAG, get ParallelConfig, will not get
     // during transaction execution
-    // TODO: add parallel config cache
-    // auto parallelKey = std::make_pair(string(receiveAddress), selector);
-    auto parallelConfigPrecompiled =
-        std::make_shared<precompiled::ParallelConfigPrecompiled>(m_hashImpl);
-
-    EXECUTOR_LOG(TRACE) << LOG_DESC("[getTxCriticals] get parallel config")
-                        << LOG_KV("receiveAddress", receiveAddress) << LOG_KV("selector", selector)
-                        << LOG_KV("sender", params.origin);
-
-    config = parallelConfigPrecompiled->getParallelConfig(
-        executive, receiveAddress, selector, params.origin);
-
-    if (config == nullptr)
+    auto config = m_parallelConfigCache->getOrLoad(params.receiveAddress, selector,
+        [&]() { return loadParallelConfig(params.receiveAddress, selector, params.origin); });
+    if (!config)
     {
-        return {};
+        return;
     }
-    // Testing code
-    auto res = vector<string>();
 
-    codec::abi::ABIFunc af;
-    bool isOk = af.parser(config->functionName);
-    if (!isOk)
+    if (decoded)
     {
-        EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] parser function signature failed, ")
-                            << LOG_KV("func signature", config->functionName);
-
-        return {};
+        std::vector<std::string> res;
+        codec::abi::ContractABICodec abi(m_hashImpl);
+        if (!abi.abiOutByFuncSelector(
+                ref(params.data).getCroppedData(4), config->criticalTypes, res))
+        {
+            EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] abiout failed, ")
+                                << LOG_KV("func signature", config->config.functionName);
+            return;
+        }
+        for (auto& critical : res)
+        {
+            criticals.push_back(CriticalKey::hash(critical + params.receiveAddress));
+        }
+        return;
     }
-
-    auto paramTypes = af.getParamsType();
-    if (paramTypes.size() < (size_t)config->criticalSize)
+    if (!config->extractor)
     {
-        EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] params type less than  criticalSize")
-                            << LOG_KV("func signature", config->functionName)
-                            << LOG_KV("func criticalSize", config->criticalSize);
-
-        return {};
+        return;
     }
 
-    paramTypes.resize((size_t)config->criticalSize);
-
-    codec::abi::ContractABICodec abi(m_hashImpl);
-    isOk = abi.abiOutByFuncSelector(ref(params.data).getCroppedData(4), paramTypes, res);
-    if (!isOk)
+    // the keys point into the calldata, no ABI decoding
+    if (!config->extractor->extract(ref(params.data).getCroppedData(4), scope, criticals))
     {
         EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] abiout failed, ")
-                            << LOG_KV("func signature", config->functionName);
-
-        return {};
+                            << LOG_KV("func signature", config->config.functionName);
     }
+}
+
+precompiled::ParsedParallelConfig::Ptr TransactionExecutor::loadParallelConfig(
+    const std::string& receiveAddress, uint32_t selector, const std::string& origin)
+{
+    EXECUTOR_LOG(TRACE) << LOG_DESC("[getTxCriticals] get parallel config")
+                        << LOG_KV("receiveAddress", receiveAddress) << LOG_KV("selector", selector)
+                        << LOG_KV("sender", origin);
 
-    for (string& critical : res)
+    // read the block storage directly, no temp executive
+    auto config = m_parallelConfigPrecompiled->getParallelConfig(
+        *m_blockContext->storage(), receiveAddress, selector);
+
+    precompiled::ParsedParallelConfig::Ptr parsed = nullptr;
+    if (config)
     {
-        critical += params.receiveAddress;
+        codec::abi::ABIFunc af;
+        bool isOk = af.parser(config->functionName);
+        auto paramTypes = af.getParamsType();
+        if (!isOk)
+        {
+            EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] parser function signature failed, ")
+                                << LOG_KV("func signature", config->functionName);
+        }
+        else if (paramTypes.size() < (size_t)config->criticalSize)
+        {
+            EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] params type less than  criticalSize")
+                                << LOG_KV("func signature", config->functionName)
+                                << LOG_KV("func criticalSize", config->criticalSize);
+        }
+        else
+        {
+            paramTypes.resize((size_t)config->criticalSize);
+            auto extractor = CriticalExtractor::compile(paramTypes);
+            if (!extractor)
+            {
+                // executed serially from Version_3_1_0, rather than keyed in another way than
+                // the other functions
+                EXECUTOR_LOG(DEBUG) << LOG_DESC("[getTxCriticals] unsupported critical type")
+                                    << LOG_KV("func signature", config->functionName);
+            }
+            parsed = std::make_shared<const precompiled::ParsedParallelConfig>(
+                precompiled::ParsedParallelConfig{
+                    std::move(*config), std::move(paramTypes), std::move(extractor)});
+        }
     }
 
-    return res;
-}
\ No newline at end of file
+    return parsed;
+}
@@ -0,0 +1,147 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @file ParallelConfigCache.cpp
+ * @author: xingqiangbai
+ * @date 2021-12-13
+ */
+
+#include "ParallelConfigCache.h"
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::precompiled;
+
+std::optional<ParsedParallelConfig::Ptr> ParallelConfigCache::lookup(
+    const std::string& _address, uint32_t _selector) const
+{
+    std::shared_lock<std::shared_mutex> lock(x_configs);
+    auto contract = m_configs.find(_address);
+    if (contract == m_configs.end())
+    {
+        return std::nullopt;
+    }
+    auto it = contract->second.find(_selector);
+    if (it == contract->second.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void ParallelConfigCache::insert(const std::string& _address, uint32_t _selector,
+    ParsedParallelConfig::Ptr _config, uint64_t _generation)
+{
+    std::unique_lock<std::shared_mutex> lock(x_configs);
+    if (_generation != m_generation)
+    {
+        return;
+    }
+    auto contract = m_configs.find(_address);
+    if (contract != m_configs.end())
+    {
+        auto it = contract->second.find(_selector);
+        if (it != contract->second.end())
+        {
+            it->second = std::move(_config);
+            return;
+        }
+    }
+    // an evicted entry is loaded again on its next miss, as the state it reflects is unchanged
+    while (m_size >= m_capacity && !m_configs.empty())
+    {
+        auto victim = m_configs.begin();
+        m_size -= victim->second.size();
+        m_configs.erase(victim);
+    }
+    m_configs[_address][_selector] = std::move(_config);
+    ++m_size;
+}
+
+ParsedParallelConfig::Ptr ParallelConfigCache::getOrLoad(const std::string& _address,
+    uint32_t _selector, const std::function<ParsedParallelConfig::Ptr()>& _loader)
+{
+    auto cached = lookup(_address, _selector);
+    if (cached.has_value())
+    {
+        return cached.value();
+    }
+
+    auto load = [&]() {
+        // a config written after this point invalidates what is loaded here
+        auto generation = this->generation();
+        auto config = _loader();
+        insert(_address, _selector, config, generation);
+        return config;
+    };
+    ParsedParallelConfig::Ptr config;
+    auto key = _address;
+    key.append((const char*)&_selector, sizeof(_selector));
+    auto loaded = m_loads.run(key, [&]() {
+        // a load of the entry may have finished between the lookup and this one
+        cached = lookup(_address, _selector);
+        config = cached.has_value() ? cached.value() : load();
+    });
+    if (!loaded)
+    {
+        cached = lookup(_address, _selector);
+        // the loaded config was invalidated meanwhile
+        config = cached.has_value() ? cached.value() : load();
+    }
+    return config;
+}
+
+void ParallelConfigCache::invalidate(const std::string& _address, uint32_t _selector)
+{
+    std::unique_lock<std::shared_mutex> lock(x_configs);
+    ++m_generation;
+    auto contract = m_configs.find(_address);
+    if (contract != m_configs.end())
+    {
+        m_size -= contract->second.erase(_selector);
+    }
+}
+
+void ParallelConfigCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(x_configs);
+    ++m_generation;
+    m_configs.clear();
+    m_size = 0;
+}
+
+void ParallelConfigCache::onBlock(int64_t _number)
+{
+    std::unique_lock<std::shared_mutex> lock(x_configs);
+    if (_number <= m_lastBlock)
+    {
+        ++m_generation;
+        m_configs.clear();
+        m_size = 0;
+    }
+    m_lastBlock = _number;
+}
+
+uint64_t ParallelConfigCache::generation() const
+{
+    std::shared_lock<std::shared_mutex> lock(x_configs);
+    return m_generation;
+}
+
+size_t ParallelConfigCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(x_configs);
+    return m_size;
+}
@@ -0,0 +1,100 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @file ParallelConfigCache.h
+ * @author: xingqiangbai
+ * @date 2021-12-13
+ */
+
+#pragma once
+#include "../dag/CriticalExtractor.h"
+#include "../dag/SingleFlight.h"
+#include "ParallelConfigPrecompiled.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bcos
+{
+namespace precompiled
+{
+// ParallelConfig of a function with the types of its critical params and their extractor
+struct ParsedParallelConfig
+{
+    using Ptr = std::shared_ptr<const ParsedParallelConfig>;
+    ParallelConfig config;
+    // decoded by the blocks before Version_3_1_0
+    std::vector<std::string> criticalTypes;
+    // nullopt if a type is not supported, the function is not parallel from Version_3_1_0
+    std::optional<executor::CriticalExtractor> extractor;
+};
+
+/*
+    Cache of the cp_<addr> rows used by the conflict analysis, keyed by (address, selector).
+    A null entry means the function is not parallel. Entries are dropped by the writes of
+    registerParallelFunction/unregisterParallelFunction, and all of them when the executor goes
+    back to a block at or before the last one seen, e.g. after a reset or rollback.
+    The selectors of the transactions are chosen by their senders, so the number of entries is
+    bounded by a capacity, whole contracts are dropped to make room for a new entry.
+*/
+class ParallelConfigCache
+{
+public:
+    using Ptr = std::shared_ptr<ParallelConfigCache>;
+    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit ParallelConfigCache(size_t _capacity = DEFAULT_CAPACITY) : m_capacity(_capacity) {}
+
+    // nullopt if not cached, a null Ptr if cached as not parallel
+    std::optional<ParsedParallelConfig::Ptr> lookup(
+        const std::string& _address, uint32_t _selector) const;
+
+    // Insert the entry loaded since generation() returned _generation, the entry is dropped if
+    // it was invalidated meanwhile
+    void insert(const std::string& _address, uint32_t _selector, ParsedParallelConfig::Ptr _config,
+        uint64_t _generation);
+
+    // Look up the entry, or load it by _loader on a miss and insert it. Concurrent misses of the
+    // same entry load it once, the other threads wait for the load.
+    ParsedParallelConfig::Ptr getOrLoad(const std::string& _address, uint32_t _selector,
+        const std::function<ParsedParallelConfig::Ptr()>& _loader);
+
+    void invalidate(const std::string& _address, uint32_t _selector);
+    void clear();
+
+    // Clear the cache if _number is not after the last block seen
+    void onBlock(int64_t _number);
+
+    uint64_t generation() const;
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex x_configs;
+    std::unordered_map<std::string, std::unordered_map<uint32_t, ParsedParallelConfig::Ptr>>
+        m_configs;
+    size_t m_capacity;
+    size_t m_size = 0;
+    uint64_t m_generation = 0;
+    int64_t m_lastBlock = -1;
+    executor::SingleFlight<std::string> m_loads;
+};
+}  // namespace precompiled
+}  // namespace bcos
@@ -20,6 +20,7 @@
 
 #include "ParallelConfigPrecompiled.h"
 #include "Common.h"
+#include "ParallelConfigCache.h"
 #include "PrecompiledResult.h"
 #include "Utilities.h"
 #include <bcos-framework/interfaces/protocol/CommonError.h>
@@ -130,20 +131,20 @@ void ParallelConfigPrecompiled::registerParallelFunction(PrecompiledCodec::Ptr _
     std::shared_ptr<Table> table = nullptr;
     std::string functionName;
     u256 criticalSize;
+    std::string contractAddress;
     auto blockContext = _executive->blockContext().lock();
 
     if (blockContext->isWasm())
     {
-        std::string contractName;
-        _codec->decode(_data, contractName, functionName, criticalSize);
-        table = openTable(_executive, contractName, _origin);
+        _codec->decode(_data, contractAddress, functionName, criticalSize);
     }
     else
     {
         Address contractName;
         _codec->decode(_data, contractName, functionName, criticalSize);
-        table = openTable(_executive, contractName.hex(), _origin);
+        contractAddress = contractName.hex();
     }
+    table = openTable(_executive, contractAddress, _origin);
     uint32_t selector = getFuncSelector(functionName, m_hashImpl);
     if (table)
     {
@@ -152,6 +153,11 @@ void ParallelConfigPrecompiled::registerParallelFunction(PrecompiledCodec::Ptr _
         entry.setObject(config);
 
         table->setRow(std::to_string(selector), entry);
+        // after the write, so that a config loaded meanwhile is not cached
+        if (blockContext->parallelConfigCache())
+        {
+            blockContext->parallelConfigCache()->invalidate(contractAddress, selector);
+        }
         PRECOMPILED_LOG(DEBUG) << LOG_BADGE("ParallelConfigPrecompiled")
                                << LOG_DESC("registerParallelFunction success")
                                << LOG_KV(PARA_SELECTOR, std::to_string(selector))
@@ -166,25 +172,29 @@ void ParallelConfigPrecompiled::unregisterParallelFunction(PrecompiledCodec::Ptr
     std::string const&, bytes& _out)
 {
     std::string functionName;
+    std::string contractAddress;
     std::optional<Table> table = nullopt;
     auto blockContext = _executive->blockContext().lock();
     if (blockContext->isWasm())
     {
-        std::string contractAddress;
         _codec->decode(_data, contractAddress, functionName);
-        table = _executive->storage().openTable(getTableName(contractAddress));
     }
     else
     {
-        Address contractAddress;
-        _codec->decode(_data, contractAddress, functionName);
-        table = _executive->storage().openTable(getTableName(contractAddress.hex()));
+        Address contractName;
+        _codec->decode(_data, contractName, functionName);
+        contractAddress = contractName.hex();
     }
+    table = _executive->storage().openTable(getTableName(contractAddress));
 
     uint32_t selector = getFuncSelector(functionName, m_hashImpl);
     if (table)
     {
         table->setRow(std::to_string(selector), table->newDeletedEntry());
+        if (blockContext->parallelConfigCache())
+        {
+            blockContext->parallelConfigCache()->invalidate(contractAddress, selector);
+        }
         _out = _codec->encode(u256(0));
         PRECOMPILED_LOG(DEBUG) << LOG_BADGE("ParallelConfigPrecompiled")
                                << LOG_DESC("unregisterParallelFunction success")
@@ -197,7 +207,13 @@ ParallelConfig::Ptr ParallelConfigPrecompiled::getParallelConfig(
     const std::string_view& _contractAddress, uint32_t _selector, const std::string_view&)
 {
     auto blockContext = _executive->blockContext().lock();
-    auto table = blockContext->storage()->openTable(getTableName(_contractAddress));
+    return getParallelConfig(*blockContext->storage(), _contractAddress, _selector);
+}
+
+ParallelConfig::Ptr ParallelConfigPrecompiled::getParallelConfig(
+    storage::StateStorage& _storage, const std::string_view& _contractAddress, uint32_t _selector)
+{
+    auto table = _storage.openTable(getTableName(_contractAddress));
     if (!table)
     {
         return nullptr;
@@ -102,6 +102,10 @@ public:
         std::shared_ptr<executor::TransactionExecutive> _executive,
         const std::string_view& _contractAddress, uint32_t _selector,
         const std::string_view& _origin);
+
+    /// get parallel config from the storage directly, without an executive
+    ParallelConfig::Ptr getParallelConfig(storage::StateStorage& _storage,
+        const std::string_view& _contractAddress, uint32_t _selector);
 };
 }  // namespace precompiled
 }  // namespace bcos
\ No newline at end of file
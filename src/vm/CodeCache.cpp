@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief cache of contract code keyed by code hash
+ * @file CodeCache.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-15
+ */
+
+#include "CodeCache.h"
+#include "../Common.h"
+#include <mutex>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+ContractCode::ContractCode(bytesConstRef _code)
+  : code(_code.toBytes()), kind(hasWasmPreamble(_code) ? VMKind::Hera : VMKind::evmone)
+{}
+
+CodeCache& CodeCache::instance()
+{
+    static CodeCache codeCache;
+    return codeCache;
+}
+
+bool CodeCache::toKey(std::string_view _codeHash, Key& _key)
+{
+    if (_codeHash.size() != CODE_HASH_SIZE)
+    {
+        return false;
+    }
+    memcpy(_key.data(), _codeHash.data(), CODE_HASH_SIZE);
+    return true;
+}
+
+ContractCode::Ptr CodeCache::lookup(std::string_view _codeHash)
+{
+    Key key;
+    if (!toKey(_codeHash, key))
+    {
+        return nullptr;
+    }
+    std::shared_lock lock(m_mutex);
+    auto it = m_items.find(key);
+    if (it == m_items.end())
+    {
+        return nullptr;
+    }
+    it->second.referenced.store(true, std::memory_order_relaxed);
+    return it->second.code;
+}
+
+ContractCode::Ptr CodeCache::insert(std::string_view _codeHash, bytesConstRef _code)
+{
+    // built out of the lock, the code of a hash is the same whoever inserts it
+    auto contractCode = std::make_shared<const ContractCode>(_code);
+    Key key;
+    if (!toKey(_codeHash, key) || _code.size() > m_capacity)
+    {
+        return contractCode;
+    }
+
+    std::unique_lock lock(m_mutex);
+    auto it = m_items.find(key);
+    if (it != m_items.end())
+    {
+        return it->second.code;
+    }
+    evict(_code.size());
+    m_items.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(contractCode));
+    m_clock.push_back(key);
+    m_usage += _code.size();
+    return contractCode;
+}
+
+void CodeCache::evict(size_t _size)
+{
+    while (m_usage + _size > m_capacity && !m_clock.empty())
+    {
+        auto key = m_clock.front();
+        m_clock.pop_front();
+        auto it = m_items.find(key);
+        if (it->second.referenced.exchange(false, std::memory_order_relaxed))
+        {
+            m_clock.push_back(key);
+            continue;
+        }
+        m_usage -= it->second.code->code.size();
+        m_items.erase(it);
+    }
+}
+
+size_t CodeCache::size() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_items.size();
+}
+
+size_t CodeCache::usage() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_usage;
+}
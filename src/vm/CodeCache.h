@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief cache of contract code keyed by code hash
+ * @file CodeCache.h
+ * @author: xingqiangbai
+ * @date: 2021-12-15
+ */
+
+#pragma once
+#include "VMFactory.h"
+#include "bcos-framework/libutilities/Common.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace bcos
+{
+namespace executor
+{
+// Immutable code of a contract with the VM it runs on, shared by all the calls executing it
+struct ContractCode
+{
+    using Ptr = std::shared_ptr<const ContractCode>;
+
+    explicit ContractCode(bytesConstRef _code);
+
+    bytes code;
+    VMKind kind;
+};
+
+// Process-wide cache of contract code keyed by the binary code hash. The code of a hash never
+// changes, so entries are never stale: setCode() writes a new hash for the account and the old
+// code is just not looked up any more. Entries are evicted by second chance when the total code
+// size exceeds the capacity.
+class CodeCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+    static constexpr size_t CODE_HASH_SIZE = 32;
+
+    explicit CodeCache(size_t _capacity = DEFAULT_CAPACITY) : m_capacity(_capacity) {}
+
+    static CodeCache& instance();
+
+    // Null if _codeHash is not cached
+    ContractCode::Ptr lookup(std::string_view _codeHash);
+
+    // Cache _code as the code of _codeHash and return it, the code is not cached if _codeHash is
+    // not CODE_HASH_SIZE bytes or _code is larger than the capacity
+    ContractCode::Ptr insert(std::string_view _codeHash, bytesConstRef _code);
+
+    size_t size() const;
+    size_t usage() const;
+    size_t capacity() const { return m_capacity; }
+
+private:
+    using Key = std::array<char, CODE_HASH_SIZE>;
+    struct KeyHash
+    {
+        size_t operator()(const Key& _key) const
+        {
+            // the key is a hash already
+            size_t value;
+            memcpy(&value, _key.data(), sizeof(value));
+            return value;
+        }
+    };
+    struct Item
+    {
+        explicit Item(ContractCode::Ptr _code) : code(std::move(_code)) {}
+
+        ContractCode::Ptr code;
+        // set by lookups, the item survives one more round of eviction
+        std::atomic_bool referenced = {false};
+    };
+
+    static bool toKey(std::string_view _codeHash, Key& _key);
+
+    // Evict until _size more bytes fit, must hold the unique lock
+    void evict(size_t _size);
+
+    const size_t m_capacity;
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<Key, Item, KeyHash> m_items;
+    // keys in insertion order, the front is the next to examine for eviction
+    std::deque<Key> m_clock;
+    size_t m_usage = 0;
+};
+
+}  // namespace executor
+}  // namespace bcos
@@ -268,6 +268,11 @@ bool HostContext::setCode(bytes code)
     {
         Entry codeHashEntry;
         auto codeHash = hashImpl()->hash(code);
+        // warm the cache, the code of a hash never changes even if this call is reverted
+        auto codeHashRef = codeHash.ref();
+        CodeCache::instance().insert(
+            std::string_view((const char*)codeHashRef.data(), codeHashRef.size()), ref(code));
+        m_code.reset();
         codeHashEntry.importFields({codeHash.asBytes()});
         m_executive->storage().setRow(m_tableName, ACCOUNT_CODE_HASH, std::move(codeHashEntry));
 
@@ -372,15 +377,49 @@ std::string_view HostContext::myAddress() const
 
 bytesConstRef HostContext::code()
 {
-    auto entry = m_executive->storage().getRow(m_tableName, ACCOUNT_CODE);
-    if (entry)
+    auto code = contractCode();
+    return code ? ref(code->code) : bytesConstRef();
+}
+
+ContractCode::Ptr HostContext::contractCode()
+{
+    if (m_code)
     {
-        auto code = entry->getField(0);
+        return m_code;
+    }
 
-        return bytesConstRef((bcos::byte*)code.data(), code.size());
+    auto codeHashEntry = m_executive->storage().getRow(m_tableName, ACCOUNT_CODE_HASH);
+    std::string_view codeHash;
+    if (codeHashEntry)
+    {
+        codeHash = codeHashEntry->getField(0);
+        m_code = CodeCache::instance().lookup(codeHash);
+        if (m_code)
+        {
+            return m_code;
+        }
     }
 
-    return bytesConstRef();
+    auto entry = m_executive->storage().getRow(m_tableName, ACCOUNT_CODE);
+    if (!entry)
+    {
+        return nullptr;
+    }
+    auto field = entry->getField(0);
+    auto code = bytesConstRef((bcos::byte*)field.data(), field.size());
+    // only cache code which matches its hash, e.g. not an account without the hash row
+    if (codeHashEntry)
+    {
+        auto hash = hashImpl()->hash(code);
+        auto hashRef = hash.ref();
+        if (std::string_view((const char*)hashRef.data(), hashRef.size()) == codeHash)
+        {
+            m_code = CodeCache::instance().insert(codeHash, code);
+            return m_code;
+        }
+    }
+    m_code = std::make_shared<const ContractCode>(code);
+    return m_code;
 }
 
 h256 HostContext::codeHash()
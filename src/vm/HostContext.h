@@ -22,6 +22,7 @@
 #pragma once
 
 #include "../Common.h"
+#include "CodeCache.h"
 #include "bcos-framework/interfaces/storage/Table.h"
 #include "interfaces/protocol/BlockHeader.h"
 #include <evmc/evmc.h>
@@ -119,6 +120,8 @@ public:
     std::string_view codeAddress() const { return m_callParameters->codeAddress; }
     bytesConstRef data() const { return ref(m_callParameters->data); }
     bytesConstRef code();
+    // Code of this contract, from the code cache unless the code hash is missed
+    ContractCode::Ptr contractCode();
     h256 codeHash();
     u256 salt() const { return m_salt; }
     SubState& sub() { return m_sub; }
@@ -138,6 +141,8 @@ private:
 
     CallParameters::UniquePtr m_callParameters;
     std::shared_ptr<TransactionExecutive> m_executive;
+    // held for the whole call, the VM executes in place
+    ContractCode::Ptr m_code;
     std::string m_tableName;
 
     u256 m_salt;     ///< Values used in new address construction by CREATE2
@@ -26,6 +26,7 @@
 #include <evmone/evmone.h>
 #include <hera/hera.h>
 #include <boost/program_options.hpp>
+#include <array>
 
 namespace po = boost::program_options;
 
@@ -89,8 +90,40 @@ void setVMKind(const std::string& _name)
     g_kind = VMKind::DLL;
 }
 #endif
+
+evmc_vm* createEVMC(VMKind _kind)
+{
+    switch (_kind)
+    {
+    case VMKind::Hera:
+        // TODO: Hera parses, validates and instantiates the module on every execute(), the evmc
+        // ABI has no handle of a compiled module. A module cache by code hash needs the support of
+        // Hera, e.g. an evmc option of its engine, which the tag in ProjectHera.cmake lacks.
+        return evmc_create_hera();
+    case VMKind::evmone:
+        return evmc_create_evmone();
+    case VMKind::DLL:
+        return g_evmcCreateFn();
+    default:
+        return evmc_create_evmone();
+    }
+}
+
+/// The idle VM instances of a thread, indexed by VMKind. Instances are only touched by the thread
+/// holding them, so no lock is needed.
+thread_local std::array<std::vector<std::unique_ptr<VMInstance>>, 3> t_cachedVMs;
 }  // namespace
 
+void VMRecycler::operator()(VMInstance* _instance) const
+{
+    std::unique_ptr<VMInstance> instance(_instance);
+    auto& cachedVMs = t_cachedVMs[static_cast<size_t>(kind)];
+    if (cachedVMs.size() < VMFactory::MAX_CACHED_VM_NUM)
+    {
+        cachedVMs.emplace_back(std::move(instance));
+    }
+}
+
 VMInstance VMFactory::create()
 {
     return create(g_kind);
@@ -98,17 +131,20 @@ VMInstance VMFactory::create()
 
 VMInstance VMFactory::create(VMKind _kind)
 {
-    switch (_kind)
+    return VMInstance{createEVMC(_kind)};
+}
+
+CachedVMInstance VMFactory::acquire(VMKind _kind)
+{
+    auto& cachedVMs = t_cachedVMs[static_cast<size_t>(_kind)];
+    if (!cachedVMs.empty())
     {
-    case VMKind::Hera:
-        return VMInstance{evmc_create_hera()};
-    case VMKind::evmone:
-        return VMInstance{evmc_create_evmone()};
-    case VMKind::DLL:
-        return VMInstance{g_evmcCreateFn()};
-    default:
-        return VMInstance{evmc_create_evmone()};
+        auto instance = std::move(cachedVMs.back());
+        cachedVMs.pop_back();
+        return CachedVMInstance(instance.release(), VMRecycler{_kind});
     }
+    // the options are applied by the constructor, once for the whole life of the instance
+    return CachedVMInstance(new VMInstance(createEVMC(_kind)), VMRecycler{_kind});
 }
 }  // namespace executor
 }  // namespace bcos
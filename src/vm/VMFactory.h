@@ -20,8 +20,8 @@
  */
 
 #pragma once
-#include <string>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace bcos
@@ -36,17 +36,34 @@ enum class VMKind
     DLL
 };
 
+/// Gives a leased VM instance back to the cache of the releasing thread.
+struct VMRecycler
+{
+    VMKind kind;
+    void operator()(VMInstance* _instance) const;
+};
+using CachedVMInstance = std::unique_ptr<VMInstance, VMRecycler>;
+
 class VMFactory
 {
 public:
     VMFactory() = delete;
     ~VMFactory() = delete;
 
+    /// Max idle instances of a kind kept by a thread, the others are destroyed when released.
+    static constexpr size_t MAX_CACHED_VM_NUM = 16;
+
     /// Creates a VM instance of the global kind.
     static VMInstance create();
 
     /// Creates a VM instance of the kind provided.
     static VMInstance create(VMKind _kind);
+
+    /// Leases a VM instance of the kind provided from the cache of the calling thread, or creates
+    /// one if the cache is empty. The lease is exclusive until it is destroyed, so a call nested in
+    /// a running VM gets another instance. The revision is given per execution by evmc, so the
+    /// instances of a kind are interchangeable. Idle instances live until their thread exits.
+    static CachedVMInstance acquire(VMKind _kind);
 };
 }  // namespace executor
 }  // namespace bcos
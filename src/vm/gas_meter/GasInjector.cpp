@@ -26,6 +26,9 @@
 #include "src/cast.h"
 #include "src/ir.h"
 #include "src/stream.h"
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include <iostream>
 
 using namespace std;
@@ -514,23 +517,27 @@ GasInjector::Result GasInjector::InjectMeter(const std::vector<uint8_t>& byteCod
     memory->page_limits.has_max = true;
     try
     {
-        ImportsInfo info{foundGasFunction, outOfGasIndex, 0, 0, originImportSize};
         // FIXME: main and deploy of wasm should charge memory gas first
-        for (Func* func : module.funcs)
-        {  // scan opcode and add meter logic
-            if (func->exprs.empty())
-            {
-                continue;
-            }
-            Index tempVarIndex = func->GetNumParamsAndLocals();
-            func->local_types.AppendDecl(Type::Enum::I32, 1);
-            info.tempVarForMemoryGasIndex = tempVarIndex;
-            // cout << "Func:" << func->name << ", type index:" << func->decl.type_var.index()
-            //      << ", expr size:" << func->exprs.size() << ",info.tempVarForMemoryGasIndex:" <<
-            //      info.tempVarForMemoryGasIndex
-            //      << "/" << func->local_types.size() << endl;
-            InjectMeterExprList(&func->exprs, info);
-        }
+        // the functions are independent, each one only touches its own locals and exprs. This
+        // runs in an executive coroutine, isolated so that the waiting thread doesn't take an
+        // unrelated task, which could resume another executive on this stack.
+        tbb::this_task_arena::isolate([&]() {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, module.funcs.size()),
+                [&](const tbb::blocked_range<size_t>& range) {
+                    for (auto i = range.begin(); i != range.end(); ++i)
+                    {  // scan opcode and add meter logic
+                        Func* func = module.funcs[i];
+                        if (func->exprs.empty())
+                        {
+                            continue;
+                        }
+                        ImportsInfo info{foundGasFunction, outOfGasIndex, 0,
+                            func->GetNumParamsAndLocals(), originImportSize};
+                        func->local_types.AppendDecl(Type::Enum::I32, 1);
+                        InjectMeterExprList(&func->exprs, info);
+                    }
+                });
+        });
     }
     catch (const InvalidInstruction& e)
     {
@@ -559,6 +566,45 @@ GasInjector::Result GasInjector::InjectMeter(const std::vector<uint8_t>& byteCod
     return injectResult;
 }
 
+GasInjector::Result GasInjector::InjectMeter(
+    const std::vector<uint8_t>& byteCode, std::string_view codeHash)
+{
+    auto key = std::string(codeHash);
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end())
+        {
+            return it->second;
+        }
+    }
+
+    // injected out of the lock, a result is the same whoever computes it
+    auto injectResult = InjectMeter(byteCode);
+    // a failure is not cached, it would cost nothing of the capacity and never be evicted
+    if (injectResult.status != Status::Success ||
+        injectResult.byteCode->size() > METERED_CODE_CACHE_CAPACITY)
+    {
+        return injectResult;
+    }
+    auto size = injectResult.byteCode->size();
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    if (m_cache.emplace(key, injectResult).second)
+    {
+        m_cacheOrder.push_back(std::move(key));
+        m_cacheBytes += size;
+        while (m_cacheBytes > METERED_CODE_CACHE_CAPACITY)
+        {
+            auto it = m_cache.find(m_cacheOrder.front());
+            m_cacheBytes -= it->second.byteCode->size();
+            m_cache.erase(it);
+            m_cacheOrder.pop_front();
+        }
+    }
+    return injectResult;
+}
+
 
 }  // namespace wasm
 }  // namespace bcos
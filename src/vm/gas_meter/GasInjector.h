@@ -19,8 +19,13 @@
  */
 #pragma once
 #include "Metric.h"
+#include <deque>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace wabt
@@ -36,6 +41,8 @@ namespace wasm
 {
 const uint64_t WASM_MEMORY_PAGES_INIT = 16;
 const uint64_t WASM_MEMORY_PAGES_MAX = 1024;
+// max total size of the metered code cached by a GasInjector
+const size_t METERED_CODE_CACHE_CAPACITY = 64 * 1024 * 1024;
 class GasInjector
 {
 public:
@@ -64,12 +71,23 @@ public:
     struct Result
     {
         Status status;
-        std::shared_ptr<std::vector<uint8_t>> byteCode;
+        // shared with the cache, never modified
+        std::shared_ptr<const std::vector<uint8_t>> byteCode;
     };
     GasInjector(const InstructionTable costTable) : m_costTable(costTable) {}
 
     Result InjectMeter(const std::vector<uint8_t>& byteCode);
 
+    // InjectMeter with the successful results cached by codeHash, the hash of byteCode, so that
+    // deploying the same code again costs a lookup
+    Result InjectMeter(const std::vector<uint8_t>& byteCode, std::string_view codeHash);
+
+    size_t cachedSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        return m_cache.size();
+    }
+
 private:
     struct ImportsInfo
     {
@@ -81,6 +99,12 @@ private:
     };
     void InjectMeterExprList(wabt::ExprList* exprs, const ImportsInfo& info);
     const InstructionTable m_costTable;
+
+    mutable std::mutex m_cacheMutex;
+    std::unordered_map<std::string, Result> m_cache;
+    // keys in insertion order, the front is evicted first
+    std::deque<std::string> m_cacheOrder;
+    size_t m_cacheBytes = 0;
 };
 }  // namespace wasm
 }  // namespace bcos
@@ -0,0 +1,845 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : unitest for DAG schedulers
+ * @author: xingqiangbai
+ * @date: 2021-12-06
+ */
+
+#include "../src/dag/CriticalExtractor.h"
+#include "../src/dag/DAG.h"
+#include "../src/dag/PriorityDAG.h"
+#include "../src/dag/ReadWriteSet.h"
+#include "../src/dag/TxDAG.h"
+#include "../src/dag/WorkStealingDAG.h"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+
+namespace bcos
+{
+namespace test
+{
+struct DAGFixture
+{
+    // Every vertex depends on the vertex _stride before it, and every 7th vertex also depends on
+    // its predecessor, which gives both long chains and fan-out.
+    vector<pair<ID, ID>> makeEdges(ID _size, ID _stride)
+    {
+        vector<pair<ID, ID>> edges;
+        for (ID id = 0; id < _size; ++id)
+        {
+            if (id >= _stride)
+            {
+                edges.emplace_back(id - _stride, id);
+            }
+            if (id % 7 == 0 && id > 0)
+            {
+                edges.emplace_back(id - 1, id);
+            }
+        }
+        return edges;
+    }
+
+    void buildWorkStealing(
+        WorkStealingDAG& _dag, ID _size, const vector<pair<ID, ID>>& _edges, size_t _workerNum)
+    {
+        _dag.init(_size, _workerNum, _edges.size());
+        for (auto& edge : _edges)
+        {
+            _dag.addEdge(edge.first, edge.second);
+        }
+        _dag.generate();
+    }
+
+    // Returns the order number of every vertex
+    vector<ID> runWorkStealing(ID _size, const vector<pair<ID, ID>>& _edges, size_t _workerNum)
+    {
+        WorkStealingDAG dag;
+        buildWorkStealing(dag, _size, _edges, _workerNum);
+        return drainWorkStealing(dag, _size, _workerNum);
+    }
+
+    vector<ID> drainWorkStealing(WorkStealingDAG& _dag, ID _size, size_t _workerNum)
+    {
+        vector<ID> order(_size, INVALID_ID);
+        atomic<ID> counter = {0};
+        vector<thread> workers;
+        for (size_t workerId = 0; workerId < _workerNum; ++workerId)
+        {
+            workers.emplace_back([&, workerId]() {
+                ID id = _dag.waitPop(workerId);
+                while (id != INVALID_ID)
+                {
+                    do
+                    {
+                        order[id] = counter.fetch_add(1);
+                        id = _dag.consume(workerId, id);
+                    } while (id != INVALID_ID);
+                    id = _dag.waitPop(workerId);
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        return order;
+    }
+
+    // Up to 3 fields per transaction, a tenth of the fields on 8 hot accounts, duplicated fields
+    // in one transaction are kept
+    vector<vector<string>> randomCriticals(size_t _count, std::mt19937& _random)
+    {
+        vector<vector<string>> criticals(_count);
+        for (auto& txCriticals : criticals)
+        {
+            auto fieldNum = _random() % 4;
+            for (size_t i = 0; i < fieldNum; ++i)
+            {
+                auto account = (_random() % 10 == 0) ? _random() % 8 : _random() % (_count * 2);
+                txCriticals.emplace_back("account" + to_string(account));
+            }
+        }
+        return criticals;
+    }
+
+    // The edges of the fields themselves in a map, the reference of TxDAG::criticalEdges
+    vector<DAGEdge> fieldEdges(const vector<vector<string>>& _criticals)
+    {
+        vector<DAGEdge> edges;
+        CriticalField<string> latestCriticals;
+        for (ID id = 0; id < _criticals.size(); ++id)
+        {
+            for (auto& field : _criticals[id])
+            {
+                auto pId = latestCriticals.get(field);
+                if (pId != INVALID_ID)
+                {
+                    edges.emplace_back(pId, id);
+                }
+            }
+            for (auto& field : _criticals[id])
+            {
+                latestCriticals.update(field, id);
+            }
+        }
+        return edges;
+    }
+
+    // 1 or 2 accesses per transaction on 4 slots, a twentieth of them on the whole slot. The
+    // accesses are returned as (slot, key), a key of -1 is the whole slot.
+    BlockCriticals randomSharedCriticals(
+        size_t _count, std::mt19937& _random, vector<vector<pair<int, int>>>& _accesses)
+    {
+        BlockCriticals blockCriticals;
+        _accesses.assign(_count, {});
+        for (size_t id = 0; id < _count; ++id)
+        {
+            vector<CriticalKey> keys;
+            vector<CriticalKey> sharedKeys;
+            auto fieldNum = 1 + _random() % 2;
+            for (size_t i = 0; i < fieldNum; ++i)
+            {
+                int slotId = _random() % 4;
+                int key = (_random() % 20 == 0) ? -1 : (int)(_random() % (_count / 10 + 1));
+                _accesses[id].emplace_back(slotId, key);
+                auto slotKey = CriticalKey::hash("slot" + to_string(slotId));
+                if (key < 0)
+                {
+                    keys.push_back(slotKey);
+                }
+                else
+                {
+                    keys.push_back(CriticalKey::hash(to_string(slotId) + ":" + to_string(key)));
+                    sharedKeys.push_back(slotKey);
+                }
+            }
+            blockCriticals.append(keys, sharedKeys);
+        }
+        return blockCriticals;
+    }
+
+    // A quarter of the transfers touch one hot account, which makes one long chain among many
+    // short ones
+    vector<vector<string>> hotAccountCriticals(ID _count, std::mt19937& _random)
+    {
+        vector<vector<string>> criticals(_count);
+        for (auto& txCriticals : criticals)
+        {
+            txCriticals.emplace_back("account" + to_string(_random() % (_count * 4)));
+            txCriticals.emplace_back(_random() % 4 == 0 ?
+                                         string("hot") :
+                                         "account" + to_string(_random() % (_count * 4)));
+        }
+        return criticals;
+    }
+
+    // Run the DAG with _workerNum threads, every vertex busy-spins _cost, returns the makespan
+    template <typename T>
+    chrono::microseconds simulate(T& _dag, size_t _workerNum, chrono::microseconds _cost)
+    {
+        auto now = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (size_t workerId = 0; workerId < _workerNum; ++workerId)
+        {
+            workers.emplace_back([&]() {
+                ID id = _dag.waitPop();
+                while (id != INVALID_ID)
+                {
+                    do
+                    {
+                        auto deadline = chrono::steady_clock::now() + _cost;
+                        while (chrono::steady_clock::now() < deadline)
+                        {
+                        }
+                        id = _dag.consume(id);
+                    } while (id != INVALID_ID);
+                    id = _dag.waitPop();
+                }
+            });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestDAG, DAGFixture)
+
+BOOST_AUTO_TEST_CASE(WorkStealingTopologicalOrder)
+{
+    ID size = 10000;
+    auto edges = makeEdges(size, 16);
+    for (size_t workerNum : {1, 2, 8})
+    {
+        auto order = runWorkStealing(size, edges, workerNum);
+        for (auto id : order)
+        {
+            BOOST_REQUIRE(id != INVALID_ID);
+        }
+        for (auto& edge : edges)
+        {
+            BOOST_REQUIRE_LT(order[edge.first], order[edge.second]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(WorkStealingStop)
+{
+    WorkStealingDAG dag;
+    dag.init(2, 2);
+    dag.addEdge(0, 1);
+    dag.generate();
+
+    // vertex 0 is never consumed, so worker 1 has to park until stop()
+    auto first = dag.waitPop(0);
+    BOOST_CHECK_EQUAL(first, 0);
+    thread waiter([&]() { BOOST_CHECK_EQUAL(dag.waitPop(1), INVALID_ID); });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    dag.stop();
+    waiter.join();
+}
+
+BOOST_AUTO_TEST_CASE(ClassicAndWorkStealingConsumeAll)
+{
+    ID size = 1000;
+    auto edges = makeEdges(size, 3);
+
+    DAG classic;
+    classic.init(size);
+    for (auto& edge : edges)
+    {
+        classic.addEdge(edge.first, edge.second);
+    }
+    classic.generate();
+    ID consumed = 0;
+    ID id = classic.waitPop();
+    while (id != INVALID_ID)
+    {
+        do
+        {
+            ++consumed;
+            id = classic.consume(id);
+        } while (id != INVALID_ID);
+        id = classic.waitPop();
+    }
+    BOOST_CHECK_EQUAL(consumed, size);
+
+    auto order = runWorkStealing(size, edges, 4);
+    BOOST_CHECK_EQUAL(order.size(), size);
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench. That all the vertexes
+// are consumed is checked by ClassicAndWorkStealingConsumeAll.
+BOOST_AUTO_TEST_CASE(
+    BuildAndDrainScale, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    auto workerNum = std::max(thread::hardware_concurrency(), 1u);
+    for (ID size : {1000, 10000, 100000})
+    {
+        auto edges = makeEdges(size, 16);
+
+        auto now = chrono::steady_clock::now();
+        DAG classic;
+        classic.init(size, edges.size());
+        for (auto& edge : edges)
+        {
+            classic.addEdge(edge.first, edge.second);
+        }
+        classic.generate();
+        auto buildElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+
+        now = chrono::steady_clock::now();
+        ID consumed = 0;
+        ID id = classic.waitPop();
+        while (id != INVALID_ID)
+        {
+            do
+            {
+                ++consumed;
+                id = classic.consume(id);
+            } while (id != INVALID_ID);
+            id = classic.waitPop();
+        }
+        auto drainElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+        cout << "DAG vertexes: " << consumed << " edges: " << classic.edgeNum()
+             << " build(us): " << buildElapsed.count() << " drain(us): " << drainElapsed.count()
+             << endl;
+
+        now = chrono::steady_clock::now();
+        WorkStealingDAG workStealing;
+        buildWorkStealing(workStealing, size, edges, workerNum);
+        buildElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+
+        now = chrono::steady_clock::now();
+        drainWorkStealing(workStealing, size, workerNum);
+        drainElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+        cout << "WorkStealingDAG vertexes: " << size << " workers: " << workerNum
+             << " build(us): " << buildElapsed.count() << " drain(us): " << drainElapsed.count()
+             << endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelCriticalEdges)
+{
+    std::mt19937 random(20211206);
+    for (size_t count : {100, 5000})
+    {
+        auto criticals = randomCriticals(count, random);
+        auto blockCriticals = BlockCriticals::fromFields(criticals);
+        auto serialEdges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+        BOOST_CHECK(serialEdges == fieldEdges(criticals));
+        BOOST_CHECK(
+            serialEdges == TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, true));
+    }
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench
+BOOST_AUTO_TEST_CASE(
+    ParallelCriticalEdgesBench, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    std::mt19937 random(20211206);
+    for (size_t count : {100, 5000, 50000})
+    {
+        auto criticals = randomCriticals(count, random);
+
+        auto now = chrono::steady_clock::now();
+        auto blockCriticals = BlockCriticals::fromFields(criticals);
+        auto hashElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+
+        now = chrono::steady_clock::now();
+        auto serialEdges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+        auto serialElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+
+        now = chrono::steady_clock::now();
+        auto parallelEdges =
+            TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, true);
+        auto parallelElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+
+        cout << "criticalEdges txs: " << count << " edges: " << serialEdges.size()
+             << " parallel edges: " << parallelEdges.size() << " hash(us): " << hashElapsed.count()
+             << " serial(us): " << serialElapsed.count()
+             << " parallel(us): " << parallelElapsed.count() << endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SharedCriticals)
+{
+    // slot-wide accesses are exclusive on the slot, keyed accesses are exclusive on the key and
+    // shared on the slot, as the conflict fields of wasm
+    auto slot = CriticalKey::hash("slot");
+    auto keyA = CriticalKey::hash("slot:a");
+    auto keyB = CriticalKey::hash("slot:b");
+    BlockCriticals criticals;
+    criticals.append({slot});
+    criticals.append({keyA}, {slot});
+    criticals.append({keyB}, {slot});
+    criticals.append({slot});
+    criticals.append({keyA}, {slot});
+
+    vector<DAGEdge> expectedEdges = {{0, 1}, {0, 2}, {0, 3}, {1, 3}, {2, 3}, {1, 4}, {3, 4}};
+    BOOST_CHECK(TxDAG::criticalEdges(criticals.spans(), false) == expectedEdges);
+    BOOST_CHECK(TxDAG::criticalEdges(criticals.spans(), true) == expectedEdges);
+
+    // every conflicting pair is ordered by a path, and serial and parallel agree
+    std::mt19937 random(20211211);
+    for (size_t count : {300, 10000})
+    {
+        vector<vector<pair<int, int>>> accesses;
+        auto blockCriticals = randomSharedCriticals(count, random, accesses);
+        auto serialEdges = TxDAG::criticalEdges(blockCriticals.spans(), false);
+        BOOST_CHECK(serialEdges == TxDAG::criticalEdges(blockCriticals.spans(), true));
+
+        if (count > 300)
+        {
+            continue;
+        }
+        vector<vector<bool>> reachable(count, vector<bool>(count, false));
+        for (auto& edge : serialEdges)
+        {
+            BOOST_CHECK_LT(edge.first, edge.second);
+            reachable[edge.first][edge.second] = true;
+        }
+        // ID order is a topological order
+        for (size_t to = 0; to < count; ++to)
+        {
+            for (size_t from = 0; from < to; ++from)
+            {
+                if (!reachable[from][to])
+                {
+                    continue;
+                }
+                for (size_t next = to + 1; next < count; ++next)
+                {
+                    if (reachable[to][next])
+                    {
+                        reachable[from][next] = true;
+                    }
+                }
+            }
+        }
+        auto conflict = [](const pair<int, int>& _lhs, const pair<int, int>& _rhs) {
+            return _lhs.first == _rhs.first &&
+                   (_lhs.second < 0 || _rhs.second < 0 || _lhs.second == _rhs.second);
+        };
+        for (size_t to = 0; to < count; ++to)
+        {
+            for (size_t from = 0; from < to; ++from)
+            {
+                bool conflicted = false;
+                for (auto& lhs : accesses[from])
+                {
+                    for (auto& rhs : accesses[to])
+                    {
+                        conflicted = conflicted || conflict(lhs, rhs);
+                    }
+                }
+                if (conflicted)
+                {
+                    BOOST_CHECK(reachable[from][to]);
+                }
+            }
+        }
+    }
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench
+BOOST_AUTO_TEST_CASE(
+    SharedCriticalsBench, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    std::mt19937 random(20211211);
+    for (size_t count : {300, 10000, 100000})
+    {
+        vector<vector<pair<int, int>>> accesses;
+        auto blockCriticals = randomSharedCriticals(count, random, accesses);
+
+        auto now = chrono::steady_clock::now();
+        auto serialEdges = TxDAG::criticalEdges(blockCriticals.spans(), false);
+        auto serialElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+        now = chrono::steady_clock::now();
+        auto parallelEdges = TxDAG::criticalEdges(blockCriticals.spans(), true);
+        auto parallelElapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - now);
+        cout << "shared criticalEdges txs: " << count << " edges: " << serialEdges.size()
+             << " parallel edges: " << parallelEdges.size()
+             << " serial(us): " << serialElapsed.count()
+             << " parallel(us): " << parallelElapsed.count() << endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CriticalKeyField)
+{
+    CriticalField<CriticalKey> field;
+    auto a = CriticalKey::hash("0x1234567890abcdef1234567890abcdef12345678");
+    auto b = CriticalKey::hash("0x1234567890abcdef1234567890abcdef12345679");
+    BOOST_CHECK(a != b);
+    BOOST_CHECK(a == CriticalKey::hash("0x1234567890abcdef1234567890abcdef12345678"));
+
+    BOOST_CHECK_EQUAL(field.get(a), INVALID_ID);
+    field.update(a, 1);
+    field.update(b, 2);
+    field.update(a, 3);
+    BOOST_CHECK_EQUAL(field.get(a), 3);
+    BOOST_CHECK_EQUAL(field.get(b), 2);
+
+    // grow across several rehashes
+    for (ID id = 0; id < 1000; ++id)
+    {
+        field.update(CriticalKey::hash(to_string(id)), id);
+    }
+    for (ID id = 0; id < 1000; ++id)
+    {
+        BOOST_CHECK_EQUAL(field.get(CriticalKey::hash(to_string(id))), id);
+    }
+    BOOST_CHECK_EQUAL(field.get(a), 3);
+
+    field.setCriticalAll(7);
+    BOOST_CHECK_EQUAL(field.get(a), 7);
+}
+
+BOOST_AUTO_TEST_CASE(CriticalExtractorKeys)
+{
+    auto word = [](bytes& _data, uint64_t _value, uint8_t _fill = 0) {
+        bytes w(32, _fill);
+        for (size_t i = 0; i < 8; ++i)
+        {
+            w[31 - i] = (uint8_t)(_value >> (i * 8));
+        }
+        _data.insert(_data.end(), w.begin(), w.end());
+    };
+    auto tail = [&word](bytes& _data, const std::string& _value) {
+        word(_data, _value.size());
+        _data.insert(_data.end(), _value.begin(), _value.end());
+        _data.resize(_data.size() + (32 - _value.size() % 32) % 32, 0);
+    };
+    auto view = [](const bytes& _data) { return bytesConstRef(_data.data(), _data.size()); };
+    auto scope = CriticalKey::hash("ff6f30856ad3bae00b1169808488502786a13e3c");
+
+    // transfer(string,string,uint256) with 2 critical params
+    auto transfer = CriticalExtractor::compile({"string", "string"});
+    BOOST_CHECK(transfer.has_value());
+    bytes transferData;
+    word(transferData, 96);
+    word(transferData, 160);
+    word(transferData, 10);
+    tail(transferData, "user1");
+    tail(transferData, "user99");
+    std::vector<CriticalKey> keys;
+    BOOST_CHECK(transfer->extract(view(transferData), scope, keys));
+    BOOST_CHECK_EQUAL(keys.size(), 2);
+    BOOST_CHECK(keys[0] == CriticalKey::hash("user1", scope));
+    BOOST_CHECK(keys[1] == CriticalKey::hash("user99", scope));
+    BOOST_CHECK(keys[0] != CriticalKey::hash("user1"));
+
+    // set(string,uint256) keys the same user as transfer
+    auto set = CriticalExtractor::compile({"string"});
+    bytes setData;
+    word(setData, 64);
+    word(setData, 1000000);
+    tail(setData, "user99");
+    BOOST_CHECK(set->extract(view(setData), scope, keys));
+    BOOST_CHECK_EQUAL(keys.size(), 3);
+    BOOST_CHECK(keys[2] == keys[1]);
+
+    // the bits beyond the type are cleared as the contract does
+    auto small = CriticalExtractor::compile({"uint8", "int16", "bool", "bytes4", "address"});
+    BOOST_CHECK(small.has_value());
+    bytes clean;
+    word(clean, 0x12);
+    word(clean, 0xfffe, 0xff);
+    word(clean, 1);
+    clean.insert(clean.end(), {0xde, 0xad, 0xbe, 0xef});
+    clean.resize(clean.size() + 28, 0);
+    word(clean, 0x1234);
+    bytes dirty;
+    word(dirty, 0xab12);
+    word(dirty, 0xfffe, 0x01);
+    word(dirty, 0x100);
+    dirty.insert(dirty.end(), {0xde, 0xad, 0xbe, 0xef});
+    dirty.resize(dirty.size() + 28, 0x55);
+    word(dirty, 0x1234);
+    dirty[dirty.size() - 32] = 0x77;
+    std::vector<CriticalKey> cleanKeys;
+    std::vector<CriticalKey> dirtyKeys;
+    BOOST_CHECK(small->extract(view(clean), scope, cleanKeys));
+    BOOST_CHECK(small->extract(view(dirty), scope, dirtyKeys));
+    BOOST_CHECK_EQUAL(cleanKeys.size(), 5);
+    BOOST_CHECK(cleanKeys == dirtyKeys);
+
+    // malformed calldata appends nothing
+    bytes outOfRange;
+    word(outOfRange, 1000);
+    BOOST_CHECK(!set->extract(view(outOfRange), scope, keys));
+    BOOST_CHECK(!set->extract(bytesConstRef(), scope, keys));
+    bytes tooLong;
+    word(tooLong, 32);
+    word(tooLong, 64);
+    BOOST_CHECK(!set->extract(view(tooLong), scope, keys));
+    BOOST_CHECK_EQUAL(keys.size(), 3);
+
+    BOOST_CHECK(!CriticalExtractor::compile({"string", "uint256[]"}).has_value());
+    BOOST_CHECK(!CriticalExtractor::compile({"uint7"}).has_value());
+    BOOST_CHECK(!CriticalExtractor::compile({"bytes33"}).has_value());
+    BOOST_CHECK(CriticalExtractor::compile({"uint", "int256", "bytes32", "bytes"}).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(ReadWriteSetConflicts)
+{
+    BOOST_CHECK(rowKey("/apps/a", "key") == rowKey("/apps/a", "key"));
+    BOOST_CHECK(rowKey("/apps/a", "key") != rowKey("/apps/b", "key"));
+    BOOST_CHECK(rowKey("/apps/a", "key") != rowKey("key", "/apps/a"));
+
+    ReadSet readSet;
+    readSet.read("/apps/a", "balance0");
+    readSet.read("/apps/a", "balance1");
+
+    WriteSet committed;
+    BOOST_CHECK(!committed.conflicts(readSet));
+    committed.write("/apps/a", "balance2");
+    committed.write("/apps/b", "balance0");
+    BOOST_CHECK(!committed.conflicts(readSet));
+    committed.write("/apps/a", "balance1");
+    BOOST_CHECK(committed.conflicts(readSet));
+
+    // a whole table read conflicts with any row written in the table
+    ReadSet tableRead;
+    tableRead.readTable("/apps/c");
+    BOOST_CHECK(!committed.conflicts(tableRead));
+    committed.write("/apps/c", "anything");
+    BOOST_CHECK(committed.conflicts(tableRead));
+
+    // untracked accesses are never trusted
+    ReadSet untracked;
+    untracked.setUntracked();
+    BOOST_CHECK(committed.conflicts(untracked));
+    untracked.clear();
+    BOOST_CHECK(!committed.conflicts(untracked));
+}
+
+BOOST_AUTO_TEST_CASE(EdgeReduction)
+{
+    std::mt19937 random(20211207);
+    ID count = 300;
+    vector<vector<string>> criticals(count);
+    for (auto& txCriticals : criticals)
+    {
+        auto fieldNum = random() % 4;
+        for (size_t i = 0; i < fieldNum; ++i)
+        {
+            txCriticals.emplace_back("account" + to_string(random() % 20));
+        }
+    }
+    auto blockCriticals = BlockCriticals::fromFields(criticals);
+    auto edges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+    auto reduced = edges;
+    TxDAG::reduceEdges(reduced);
+    BOOST_CHECK_LT(reduced.size(), edges.size());
+
+    // the reduced DAG must have the same reachability
+    auto closure = [count](const vector<DAGEdge>& _edges) {
+        vector<set<ID>> reachable(count);
+        // edges ordered by target, sources are lower IDs
+        for (auto& edge : _edges)
+        {
+            reachable[edge.second].insert(edge.first);
+            reachable[edge.second].insert(
+                reachable[edge.first].begin(), reachable[edge.first].end());
+        }
+        return reachable;
+    };
+    BOOST_CHECK(closure(edges) == closure(reduced));
+
+    auto statistics = TxDAG::computeStatistics(blockCriticals.offsets, edges);
+    auto reducedStatistics = TxDAG::computeStatistics(blockCriticals.offsets, reduced);
+    BOOST_CHECK_EQUAL(statistics.longestPath, reducedStatistics.longestPath);
+    BOOST_CHECK_EQUAL(statistics.widestLevel, reducedStatistics.widestLevel);
+    BOOST_CHECK_EQUAL(reducedStatistics.edgeNum, reduced.size());
+}
+
+BOOST_AUTO_TEST_CASE(Statistics)
+{
+    // 0 -> 1 -> 3, 2 independent, 4 has no critical field
+    vector<vector<string>> criticals = {{"a"}, {"a", "b"}, {"c"}, {"b"}, {}};
+    auto blockCriticals = BlockCriticals::fromFields(criticals);
+    auto edges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+    auto statistics = TxDAG::computeStatistics(blockCriticals.offsets, edges);
+    BOOST_CHECK_EQUAL(statistics.vertexNum, 4);
+    BOOST_CHECK_EQUAL(statistics.edgeNum, 2);
+    BOOST_CHECK_EQUAL(statistics.longestPath, 3);
+    BOOST_CHECK_EQUAL(statistics.widestLevel, 2);
+    BOOST_CHECK_CLOSE(statistics.speedupBound, 4.0 / 3.0, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(CriticalPathRanks)
+{
+    // 0 -> 1 -> 2 chain, 3 independent but heavy
+    PriorityDAG dag;
+    dag.init(4);
+    dag.setWeights({1, 1, 1, 5});
+    dag.addEdge(0, 1);
+    dag.addEdge(1, 2);
+    dag.generate();
+    BOOST_CHECK_EQUAL(dag.rank(0), 3);
+    BOOST_CHECK_EQUAL(dag.rank(2), 1);
+    BOOST_CHECK_EQUAL(dag.rank(3), 5);
+
+    // highest rank first
+    BOOST_CHECK_EQUAL(dag.waitPop(), 3);
+    BOOST_CHECK_EQUAL(dag.waitPop(), 0);
+    BOOST_CHECK_EQUAL(dag.consume(0), 1);
+    BOOST_CHECK_EQUAL(dag.consume(1), 2);
+    BOOST_CHECK_EQUAL(dag.consume(2), INVALID_ID);
+    BOOST_CHECK_EQUAL(dag.consume(3), INVALID_ID);
+    BOOST_CHECK_EQUAL(dag.waitPop(), INVALID_ID);
+}
+
+BOOST_AUTO_TEST_CASE(CriticalPathHotChainFirst)
+{
+    std::mt19937 random(20211208);
+    ID count = 200;
+    auto criticals = hotAccountCriticals(count, random);
+    auto blockCriticals = BlockCriticals::fromFields(criticals);
+    auto edges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+    auto statistics = TxDAG::computeStatistics(blockCriticals.offsets, edges);
+
+    PriorityDAG priority;
+    priority.init(count);
+    priority.addEdges(vector<DAGEdge>(edges));
+    priority.generate();
+
+    // the head of the longest chain is dispatched first, and every edge is kept
+    vector<ID> order(count, INVALID_ID);
+    ID counter = 0;
+    ID id = priority.waitPop();
+    BOOST_CHECK_EQUAL(priority.rank(id), statistics.longestPath);
+    while (id != INVALID_ID)
+    {
+        do
+        {
+            order[id] = counter++;
+            id = priority.consume(id);
+        } while (id != INVALID_ID);
+        id = priority.waitPop();
+    }
+    BOOST_CHECK_EQUAL(counter, count);
+    for (auto& edge : edges)
+    {
+        BOOST_CHECK_LT(order[edge.first], order[edge.second]);
+    }
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench. FIFO starts the hot
+// chain late, critical path first starts it at once.
+BOOST_AUTO_TEST_CASE(
+    CriticalPathVersusFIFO, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    std::mt19937 random(20211208);
+    ID count = 2000;
+    auto criticals = hotAccountCriticals(count, random);
+    auto blockCriticals = BlockCriticals::fromFields(criticals);
+    auto edges = TxDAG::criticalEdges(blockCriticals.keys, blockCriticals.offsets, false);
+    auto statistics = TxDAG::computeStatistics(blockCriticals.offsets, edges);
+
+    auto workerNum = 4;
+    auto cost = chrono::microseconds(20);
+
+    DAG fifo;
+    fifo.init(count);
+    fifo.addEdges(vector<DAGEdge>(edges));
+    fifo.generate();
+    auto fifoElapsed = simulate(fifo, workerNum, cost);
+
+    PriorityDAG priority;
+    priority.init(count);
+    priority.addEdges(vector<DAGEdge>(edges));
+    priority.generate();
+    auto priorityElapsed = simulate(priority, workerNum, cost);
+
+    cout << "hot account workload txs: " << count << " longestPath: " << statistics.longestPath
+         << " workers: " << workerNum << " FIFO(us): " << fifoElapsed.count()
+         << " criticalPath(us): " << priorityElapsed.count() << endl;
+}
+
+BOOST_AUTO_TEST_CASE(ExecutionControl)
+{
+    vector<vector<string>> criticals = {{"a"}, {"a"}, {"b"}, {"c"}};
+    vector<TransactionExecutive::Ptr> executives(criticals.size());
+    vector<std::unique_ptr<CallParameters>> callParameters(criticals.size());
+    vector<gsl::index> indexes(criticals.size());
+
+    for (auto type : {DAGSchedulerType::Classic, DAGSchedulerType::WorkStealing,
+             DAGSchedulerType::CriticalPath})
+    {
+        // run to the end
+        TxDAG txDag(type, 2);
+        txDag.init(criticals.size(), criticals);
+        vector<thread> workers;
+        for (size_t workerId = 0; workerId < 2; ++workerId)
+        {
+            workers.emplace_back(
+                [&, workerId]() { txDag.run(executives, callParameters, indexes, workerId); });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        BOOST_CHECK(txDag.hasFinished());
+        BOOST_CHECK(!txDag.isStopped());
+        BOOST_CHECK_EQUAL(txDag.haveExecuteNumber(), criticals.size());
+        BOOST_CHECK_EQUAL(txDag.workerStatistics().size(), 2);
+
+        // a passed deadline dispatches nothing
+        TxDAG timeoutDag(type, 2);
+        timeoutDag.init(criticals.size(), criticals);
+        timeoutDag.setDeadline(chrono::steady_clock::now());
+        timeoutDag.run(executives, callParameters, indexes, 0);
+        BOOST_CHECK(timeoutDag.isTimeout());
+        BOOST_CHECK(timeoutDag.isStopped());
+        BOOST_CHECK_EQUAL(timeoutDag.haveExecuteNumber(), 0);
+
+        // cancel
+        TxDAG stoppedDag(type, 2);
+        stoppedDag.init(criticals.size(), criticals);
+        stoppedDag.stop();
+        stoppedDag.run(executives, callParameters, indexes, 1);
+        BOOST_CHECK(!stoppedDag.isTimeout());
+        BOOST_CHECK_EQUAL(stoppedDag.haveExecuteNumber(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -21,6 +21,10 @@
 
 #include "../mock/MockTransactionalStorage.h"
 #include "../mock/MockTxPool.h"
+#include "../src/executive/BlockContext.h"
+#include "../src/executive/TransactionExecutive.h"
+#include "../src/vm/CodeCache.h"
+#include "../src/vm/HostContext.h"
 #include "Common.h"
 #include "bcos-executor/LRUStorage.h"
 #include "bcos-executor/TransactionExecutor.h"
@@ -332,6 +336,169 @@ BOOST_AUTO_TEST_CASE(deployAndCall)
         "00000000000000000000000000");
 }
 
+BOOST_AUTO_TEST_CASE(callCodeCache)
+{
+    // no cached storage, so that the next block reads the rows changed in the backend
+    auto executor = std::make_shared<TransactionExecutor>(txpool, nullptr, backend,
+        std::make_shared<NativeExecutionMessageFactory>(), hashImpl, false, false);
+    auto nextBlock = [&](int64_t number) {
+        auto blockHeader = std::make_shared<bcos::protocol::PBBlockHeader>(cryptoSuite);
+        blockHeader->setNumber(number);
+        std::promise<void> nextPromise;
+        executor->nextBlockHeader(blockHeader, [&](bcos::Error::Ptr&& error) {
+            BOOST_CHECK(!error);
+            nextPromise.set_value();
+        });
+        nextPromise.get_future().get();
+    };
+    auto commitBlock = [&](int64_t number) {
+        bcos::executor::TransactionExecutor::TwoPCParams commitParams{};
+        commitParams.number = number;
+        std::promise<void> preparePromise;
+        executor->prepare(commitParams, [&](bcos::Error::Ptr&& error) {
+            BOOST_CHECK(!error);
+            preparePromise.set_value();
+        });
+        preparePromise.get_future().get();
+        std::promise<void> commitPromise;
+        executor->commit(commitParams, [&](bcos::Error::Ptr&& error) {
+            BOOST_CHECK(!error);
+            commitPromise.set_value();
+        });
+        commitPromise.get_future().get();
+    };
+    auto execute = [&](std::unique_ptr<NativeExecutionMessage> params) {
+        std::promise<ExecutionMessage::UniquePtr> executePromise;
+        executor->executeTransaction(std::move(params),
+            [&](bcos::Error::UniquePtr&& error, ExecutionMessage::UniquePtr&& result) {
+                BOOST_CHECK(!error);
+                executePromise.set_value(std::move(result));
+            });
+        return executePromise.get_future().get();
+    };
+
+    bytes input;
+    boost::algorithm::unhex(helloBin, std::back_inserter(input));
+    auto tx = fakeTransaction(cryptoSuite, keyPair, "", input, 102, 100001, "1", "1");
+    auto sender = *toHexString(string_view((char*)tx->sender().data(), tx->sender().size()));
+    txpool->hash2Transaction.emplace(tx->hash(), tx);
+
+    auto params = std::make_unique<NativeExecutionMessage>();
+    params->setContextID(200);
+    params->setSeq(1000);
+    params->setDepth(0);
+    h256 addressCreate("ee6f30856ad3bae00b1169808488502786a13e3c174d85682135ffd51310310e");
+    params->setTo(addressCreate.hex().substr(0, 40));
+    params->setStaticCall(false);
+    params->setGasAvailable(gas);
+    params->setType(ExecutionMessage::TXHASH);
+    params->setTransactionHash(tx->hash());
+    params->setCreate(true);
+
+    nextBlock(1);
+    auto result = execute(std::move(params));
+    BOOST_CHECK_EQUAL(result->status(), 0);
+    auto address = std::string(result->newEVMContractAddress());
+    commitBlock(1);
+
+    // get() of the contract deployed, or of a copy of its code without the storage
+    auto get = [&](const std::string& to, int64_t contextID) {
+        auto params = std::make_unique<NativeExecutionMessage>();
+        params->setContextID(contextID);
+        params->setSeq(1000);
+        params->setDepth(0);
+        params->setFrom(sender);
+        params->setTo(to);
+        params->setOrigin(sender);
+        params->setStaticCall(false);
+        params->setGasAvailable(gas);
+        params->setData(*fromHexString("6d4ce63c"));
+        params->setType(ExecutionMessage::MESSAGE);
+        auto result = execute(std::move(params));
+        std::string output;
+        boost::algorithm::hex_lower(
+            result->data().begin(), result->data().end(), std::back_inserter(output));
+        BOOST_CHECK_EQUAL(result->status(), 0);
+        return output;
+    };
+    std::string helloWorld =
+        "0000000000000000000000000000000000000000000000000000000000000020000000000000000000000000"
+        "000000000000000000000000000000000000000d48656c6c6f2c20576f726c64210000000000000000000000"
+        "0000000000000000";
+    auto setRow = [&](const std::string& tableName, const std::string& key, bytes value) {
+        auto table = backend->m_inner->openTable(tableName);
+        if (!table)
+        {
+            backend->m_inner->createTable(tableName, STORAGE_VALUE);
+            table = backend->m_inner->openTable(tableName);
+        }
+        Entry entry;
+        entry.importFields({std::move(value)});
+        table->setRow(key, std::move(entry));
+    };
+    auto tableName = "/apps/" + address;
+    auto codeEntry = backend->m_inner->openTable(tableName)->getRow(ACCOUNT_CODE);
+    BOOST_REQUIRE(codeEntry);
+    auto code = bytes(codeEntry->getField(0).begin(), codeEntry->getField(0).end());
+
+    // the code hash is cached, the code row is not read
+    nextBlock(2);
+    setRow(tableName, ACCOUNT_CODE, {0xfe});
+    BOOST_CHECK_EQUAL(get(address, 201), helloWorld);
+    commitBlock(2);
+
+    // a code hash which is not the one of the code, the code is read and not cached
+    nextBlock(3);
+    setRow(tableName, ACCOUNT_CODE, code);
+    auto wrongHash = hashImpl->hash(std::string("not the code"));
+    setRow(tableName, ACCOUNT_CODE_HASH, wrongHash.asBytes());
+    BOOST_CHECK_EQUAL(get(address, 301), helloWorld);
+    auto wrongHashRef = wrongHash.ref();
+    BOOST_CHECK(!CodeCache::instance().lookup(
+        std::string_view((const char*)wrongHashRef.data(), wrongHashRef.size())));
+    commitBlock(3);
+
+    // an account without the code hash row, the code is read and not cached
+    nextBlock(4);
+    auto copyAddress = std::string("cafecafecafecafecafecafecafecafecafecafe");
+    setRow("/apps/" + copyAddress, ACCOUNT_CODE, code);
+    auto cachedSize = CodeCache::instance().size();
+    BOOST_CHECK_EQUAL(get(copyAddress, 401),
+        "0000000000000000000000000000000000000000000000000000000000000020000000000000000000000000"
+        "0000000000000000000000000000000000000000");
+    BOOST_CHECK_EQUAL(CodeCache::instance().size(), cachedSize);
+    commitBlock(4);
+}
+
+BOOST_AUTO_TEST_CASE(setCodeResetsCode)
+{
+    auto storage = std::make_shared<StateStorage>(nullptr);
+    auto blockContext = std::make_shared<BlockContext>(
+        storage, hashImpl, 1, h256(), 0, 0, FiscoBcosScheduleV3, false, false);
+    std::shared_ptr<wasm::GasInjector> gasInjector;
+    std::string address = "cafecafecafecafecafecafecafecafecafecafe";
+    auto executive =
+        std::make_shared<TransactionExecutive>(blockContext, address, 0, 0, gasInjector);
+    auto tableName = "/apps/" + address;
+    storage->createTable(tableName, STORAGE_VALUE);
+    HostContext hostContext(
+        std::make_unique<CallParameters>(CallParameters::MESSAGE), executive, tableName);
+    BOOST_CHECK(!hostContext.contractCode());
+
+    // the code of the call is kept until it is set again, e.g. by a deployment
+    bytes first = {0x60, 0x01, 0x00};
+    bytes second = {0x60, 0x02, 0x00};
+    BOOST_CHECK(hostContext.setCode(first));
+    auto code = hostContext.contractCode();
+    BOOST_REQUIRE(code);
+    BOOST_CHECK(code->code == first);
+    BOOST_CHECK(hostContext.contractCode() == code);
+    BOOST_CHECK(hostContext.setCode(second));
+    BOOST_REQUIRE(hostContext.contractCode());
+    BOOST_CHECK(hostContext.contractCode()->code == second);
+    BOOST_CHECK(hostContext.code().toBytes() == second);
+}
+
 BOOST_AUTO_TEST_CASE(externalCall)
 {
     // Solidity source code from test_external_call.sol, using remix
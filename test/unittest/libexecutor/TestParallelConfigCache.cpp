@@ -0,0 +1,174 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : unitest for the ParallelConfig cache of the conflict analysis
+ * @author: xingqiangbai
+ * @date: 2021-12-13
+ */
+
+#include "../src/precompiled/ParallelConfigCache.h"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::precompiled;
+
+namespace bcos
+{
+namespace test
+{
+struct ParallelConfigCacheFixture
+{
+    ParallelConfigCacheFixture()
+    {
+        cache = make_shared<ParallelConfigCache>();
+        transfer = make_shared<const ParsedParallelConfig>(
+            ParsedParallelConfig{ParallelConfig{"transfer(string,string,uint256)", 2},
+                {"string", "string"}, executor::CriticalExtractor::compile({"string", "string"})});
+    }
+
+    shared_ptr<ParallelConfigCache> cache;
+    ParsedParallelConfig::Ptr transfer;
+    string address = "ff6f30856ad3bae00b1169808488502786a13e3c";
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestParallelConfigCache, ParallelConfigCacheFixture)
+
+BOOST_AUTO_TEST_CASE(HitAndMiss)
+{
+    BOOST_CHECK(!cache->lookup(address, 1).has_value());
+
+    cache->insert(address, 1, transfer, cache->generation());
+    // not parallel
+    cache->insert(address, 2, nullptr, cache->generation());
+
+    auto config = cache->lookup(address, 1);
+    BOOST_CHECK(config.has_value());
+    BOOST_CHECK_EQUAL(config.value()->config.functionName, "transfer(string,string,uint256)");
+    BOOST_CHECK_EQUAL(config.value()->extractor->params().size(), 2);
+
+    auto notParallel = cache->lookup(address, 2);
+    BOOST_CHECK(notParallel.has_value());
+    BOOST_CHECK(!notParallel.value());
+
+    BOOST_CHECK(!cache->lookup(address, 3).has_value());
+    BOOST_CHECK(!cache->lookup("1234", 1).has_value());
+    BOOST_CHECK_EQUAL(cache->size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Invalidate)
+{
+    cache->insert(address, 1, transfer, cache->generation());
+    cache->insert(address, 2, transfer, cache->generation());
+
+    cache->invalidate(address, 1);
+    BOOST_CHECK(!cache->lookup(address, 1).has_value());
+    BOOST_CHECK(cache->lookup(address, 2).has_value());
+
+    // loaded before the invalidation, maybe the config before the write
+    auto generation = cache->generation();
+    cache->invalidate(address, 1);
+    cache->insert(address, 1, nullptr, generation);
+    BOOST_CHECK(!cache->lookup(address, 1).has_value());
+
+    cache->insert(address, 1, transfer, cache->generation());
+    BOOST_CHECK(cache->lookup(address, 1).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(BlockVersion)
+{
+    cache->onBlock(1);
+    cache->insert(address, 1, transfer, cache->generation());
+
+    cache->onBlock(2);
+    BOOST_CHECK(cache->lookup(address, 1).has_value());
+
+    // the block 2 is executed again, its state may differ
+    cache->onBlock(2);
+    BOOST_CHECK(!cache->lookup(address, 1).has_value());
+
+    cache->insert(address, 1, transfer, cache->generation());
+    cache->clear();
+    BOOST_CHECK_EQUAL(cache->size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Capacity)
+{
+    cache = make_shared<ParallelConfigCache>(4);
+    // not parallel entries of made up selectors
+    for (uint32_t selector = 0; selector < 100; ++selector)
+    {
+        cache->insert(address, selector, nullptr, cache->generation());
+        BOOST_CHECK_LE(cache->size(), 4);
+    }
+    BOOST_CHECK(cache->lookup(address, 99).has_value());
+
+    // a whole contract is dropped for an entry of another one
+    cache->insert("1234", 1, transfer, cache->generation());
+    BOOST_CHECK_EQUAL(cache->size(), 1);
+    BOOST_CHECK(!cache->lookup(address, 99).has_value());
+    BOOST_CHECK(cache->lookup("1234", 1).has_value());
+
+    // replacing an entry needs no room
+    cache->insert("1234", 2, nullptr, cache->generation());
+    cache->insert("1234", 2, transfer, cache->generation());
+    BOOST_CHECK_EQUAL(cache->size(), 2);
+    cache->invalidate("1234", 2);
+    BOOST_CHECK_EQUAL(cache->size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GetOrLoad)
+{
+    std::atomic<int> loads = 0;
+    auto loader = [&]() {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return transfer;
+    };
+
+    // concurrent misses of an entry load it once
+    std::atomic<int> found = 0;
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&]() { found += cache->getOrLoad(address, 1, loader) ? 1 : 0; });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(found, 8);
+    BOOST_CHECK_EQUAL(loads, 1);
+    BOOST_CHECK(cache->lookup(address, 1).has_value());
+
+    // not parallel is cached too
+    BOOST_CHECK(!cache->getOrLoad(address, 2, []() { return nullptr; }));
+    BOOST_CHECK(!cache->getOrLoad(address, 2, loader));
+    BOOST_CHECK_EQUAL(loads, 1);
+
+    cache->invalidate(address, 1);
+    BOOST_CHECK(cache->getOrLoad(address, 1, loader));
+    BOOST_CHECK_EQUAL(loads, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
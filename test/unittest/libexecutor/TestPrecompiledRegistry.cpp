@@ -0,0 +1,243 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/**
+ * @brief : unitest for the precompiled registry shared by the executives
+ * @author: xingqiangbai
+ * @date: 2021-12-14
+ */
+
+#include "../src/executive/PrecompiledRegistry.h"
+#include "../src/precompiled/CryptoPrecompiled.h"
+#include "../src/vm/Precompiled.h"
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+
+using namespace std;
+using namespace bcos;
+using namespace bcos::executor;
+using namespace bcos::precompiled;
+
+namespace bcos
+{
+namespace test
+{
+// The ethereum precompiled contracts and one built-in contract, with the classification of
+// HostContext before the registry
+struct ClassifyFixture
+{
+    ClassifyFixture()
+    {
+        auto hashImpl = make_shared<Keccak256Hash>();
+        auto crypto = make_shared<CryptoPrecompiled>(hashImpl);
+        auto identity = make_shared<PrecompiledContract>(
+            15, 3, [](bytesConstRef _in) { return make_pair(true, _in.toBytes()); });
+        for (int i = 1; i <= 9; ++i)
+        {
+            registry.setEVMPrecompiled(fillZero(i), identity);
+            evmPrecompiled.emplace(fillZero(i), identity);
+        }
+        registry.setPrecompiled(fillZero(0x100a), crypto);
+        registry.setBuiltIn(fillZero(0x100a));
+        builtIn.insert(fillZero(0x100a));
+    }
+
+    static string fillZero(int _num)
+    {
+        stringstream stream;
+        stream << setfill('0') << setw(40) << hex << _num;
+        return stream.str();
+    }
+
+    // an external call heavy block, mostly calls of other contracts, some of precompiled
+    vector<string> randomAddresses(size_t _size)
+    {
+        mt19937 random(1024);
+        vector<string> addresses;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            if (i % 8 == 0)
+            {
+                addresses.push_back(fillZero(i % 16 == 0 ? 0x100a : (int)(i % 9) + 1));
+                continue;
+            }
+            stringstream stream;
+            stream << hex << setfill('0') << setw(8) << random() << setw(32) << random();
+            addresses.push_back(stream.str());
+        }
+        return addresses;
+    }
+
+    // what HostContext did for every CALL before
+    size_t classifyByPrefix(const string& _address)
+    {
+        size_t count = 0;
+        stringstream prefix;
+        prefix << setfill('0') << setw(36);
+        if (_address.find(prefix.str()) == 0 && builtIn.count(_address))
+        {
+            ++count;
+        }
+        stringstream ethereumPrefix;
+        ethereumPrefix << setfill('0') << setw(39);
+        if (_address.find(ethereumPrefix.str()) == 0 && evmPrecompiled.count(_address))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    PrecompiledRegistry registry;
+    set<string> builtIn;
+    map<string, shared_ptr<PrecompiledContract>> evmPrecompiled;
+};
+
+BOOST_AUTO_TEST_SUITE(TestPrecompiledRegistry)
+
+BOOST_AUTO_TEST_CASE(FindAndClassify)
+{
+    auto hashImpl = make_shared<Keccak256Hash>();
+    auto crypto = make_shared<CryptoPrecompiled>(hashImpl);
+    auto identity = make_shared<PrecompiledContract>(
+        15, 3, [](bytesConstRef _in) { return make_pair(true, _in.toBytes()); });
+
+    PrecompiledRegistry registry;
+    registry.setEVMPrecompiled("0000000000000000000000000000000000000004", identity);
+    registry.setPrecompiled("000000000000000000000000000000000000100a", crypto);
+    registry.setBuiltIn("000000000000000000000000000000000000100a");
+    registry.setPrecompiled("/sys/crypto_tools", crypto);
+    BOOST_CHECK_EQUAL(registry.size(), 3);
+
+    auto entry = registry.find("0000000000000000000000000000000000000004");
+    BOOST_REQUIRE(entry);
+    BOOST_CHECK(entry->evmPrecompiled == identity);
+    BOOST_CHECK(!entry->precompiled);
+    BOOST_CHECK(!entry->builtIn);
+
+    entry = registry.find("000000000000000000000000000000000000100a");
+    BOOST_REQUIRE(entry);
+    BOOST_CHECK(entry->builtIn);
+    BOOST_CHECK(registry.getPrecompiled("000000000000000000000000000000000000100a") == crypto);
+    BOOST_CHECK(registry.getPrecompiled("/sys/crypto_tools") == crypto);
+
+    // a prefix, a longer string and an unknown address are all misses
+    BOOST_CHECK(!registry.find("/sys/crypto"));
+    BOOST_CHECK(!registry.find("/sys/crypto_tools/"));
+    BOOST_CHECK(!registry.find("0000000000000000000000000000000000000005"));
+    BOOST_CHECK(!registry.find("0000000000000000000000000000000000000000000000004"));
+    BOOST_CHECK(!registry.find(""));
+
+    BOOST_CHECK_THROW(
+        registry.setPrecompiled("0000000000000000000000000000000000000000000000004", crypto),
+        bcos::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Classify)
+{
+    auto hashImpl = make_shared<Keccak256Hash>();
+    auto crypto = make_shared<CryptoPrecompiled>(hashImpl);
+    auto identity = make_shared<PrecompiledContract>(
+        15, 3, [](bytesConstRef _in) { return make_pair(true, _in.toBytes()); });
+
+    PrecompiledRegistry registry;
+    registry.setEVMPrecompiled("0000000000000000000000000000000000000004", identity);
+    registry.setPrecompiled("000000000000000000000000000000000000100a", crypto);
+    registry.setBuiltIn("000000000000000000000000000000000000100a");
+    registry.setPrecompiled("/sys/crypto_tools", crypto);
+    registry.setBuiltIn("/sys/crypto_tools");
+
+    BOOST_CHECK_EQUAL(registry.classify("0000000000000000000000000000000000000004"),
+        PrecompiledRegistry::ETHEREUM);
+    BOOST_CHECK_EQUAL(registry.classify("000000000000000000000000000000000000100a"),
+        PrecompiledRegistry::BUILT_IN);
+    BOOST_CHECK_EQUAL(registry.classify("/sys/crypto_tools"), PrecompiledRegistry::BUILT_IN);
+
+    // registered as lowercase, so that only the exact address is classified
+    BOOST_CHECK_EQUAL(registry.classify("000000000000000000000000000000000000100A"),
+        PrecompiledRegistry::NONE);
+    BOOST_CHECK_EQUAL(registry.classify("0000000000000000000000000000000000000005"),
+        PrecompiledRegistry::NONE);
+    BOOST_CHECK_EQUAL(registry.classify("1000000000000000000000000000000000000004"),
+        PrecompiledRegistry::NONE);
+    BOOST_CHECK_EQUAL(registry.classify("000000000000000000000000000000000000004"),
+        PrecompiledRegistry::NONE);
+    BOOST_CHECK_EQUAL(registry.classify("/sys/crypto"), PrecompiledRegistry::NONE);
+
+    BOOST_CHECK_EQUAL(PrecompiledRegistry::lowAddress("0000000000000000000000000000000000001000"),
+        0x1000);
+    BOOST_CHECK_EQUAL(PrecompiledRegistry::lowAddress("0000000000000000000000000000000000010000"),
+        -1);
+    BOOST_CHECK_EQUAL(PrecompiledRegistry::lowAddress("000000000000000000000000000000000000000g"),
+        -1);
+}
+
+BOOST_FIXTURE_TEST_CASE(ClassifyAsPrefix, ClassifyFixture)
+{
+    auto addresses = randomAddresses(1000);
+    size_t matched = 0;
+    for (auto& address : addresses)
+    {
+        auto addressClass = registry.classify(address);
+        size_t count = (addressClass & PrecompiledRegistry::BUILT_IN ? 1 : 0) +
+                     (addressClass & PrecompiledRegistry::ETHEREUM ? 1 : 0);
+        BOOST_CHECK_EQUAL(count, classifyByPrefix(address));
+        matched += count;
+    }
+    BOOST_CHECK_EQUAL(matched, addresses.size() / 8);
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench
+BOOST_FIXTURE_TEST_CASE(ClassifyBench, ClassifyFixture,
+    *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    auto addresses = randomAddresses(100000);
+
+    auto now = chrono::steady_clock::now();
+    size_t prefixMatched = 0;
+    for (auto& address : addresses)
+    {
+        prefixMatched += classifyByPrefix(address);
+    }
+    auto prefixElapsed = chrono::steady_clock::now() - now;
+
+    now = chrono::steady_clock::now();
+    size_t matched = 0;
+    for (auto& address : addresses)
+    {
+        auto addressClass = registry.classify(address);
+        matched += (addressClass & PrecompiledRegistry::BUILT_IN ? 1 : 0) +
+                   (addressClass & PrecompiledRegistry::ETHEREUM ? 1 : 0);
+    }
+    auto elapsed = chrono::steady_clock::now() - now;
+
+    cout << "classify addresses: " << addresses.size() << " matched: " << matched
+         << " prefix matched: " << prefixMatched << " stringstream prefix(ns/op): "
+         << chrono::duration_cast<chrono::nanoseconds>(prefixElapsed).count() / addresses.size()
+         << " registry(ns/op): "
+         << chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / addresses.size()
+         << endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief unitest of the contract code cache
+ * @file TestCodeCache.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-15
+ */
+
+#include "../../src/vm/CodeCache.h"
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+using namespace std;
+using namespace bcos::executor;
+
+namespace bcos::test
+{
+BOOST_AUTO_TEST_SUITE(testCodeCache)
+
+BOOST_AUTO_TEST_CASE(lookupAndInsert)
+{
+    CodeCache cache(1024);
+    string hash(CodeCache::CODE_HASH_SIZE, 'a');
+    bytes evmCode(100, 0x60);
+    bytes wasmCode = {0x00, 'a', 's', 'm', 0x01, 0x00, 0x00, 0x00};
+
+    BOOST_CHECK(!cache.lookup(hash));
+    auto code = cache.insert(hash, bcos::ref(evmCode));
+    BOOST_CHECK(code->code == evmCode);
+    BOOST_CHECK(code->kind == VMKind::evmone);
+    BOOST_CHECK(cache.lookup(hash) == code);
+    BOOST_CHECK_EQUAL(cache.usage(), evmCode.size());
+
+    // the first insert wins, the code of a hash never changes
+    BOOST_CHECK(cache.insert(hash, bcos::ref(wasmCode)) == code);
+
+    string wasmHash(CodeCache::CODE_HASH_SIZE, 'b');
+    auto wasm = cache.insert(wasmHash, bcos::ref(wasmCode));
+    BOOST_CHECK(wasm->kind == VMKind::Hera);
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+
+    // not cached, but still usable by the caller
+    auto invalid = cache.insert("abc", bcos::ref(evmCode));
+    BOOST_CHECK(invalid->code == evmCode);
+    BOOST_CHECK(!cache.lookup("abc"));
+    bytes hugeCode(2048, 0x60);
+    string hugeHash(CodeCache::CODE_HASH_SIZE, 'c');
+    BOOST_CHECK(cache.insert(hugeHash, bcos::ref(hugeCode))->code == hugeCode);
+    BOOST_CHECK(!cache.lookup(hugeHash));
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(evict)
+{
+    CodeCache cache(1000);
+    bytes code(300, 0x60);
+    auto hashOf = [](char _c) { return string(CodeCache::CODE_HASH_SIZE, _c); };
+
+    cache.insert(hashOf('a'), bcos::ref(code));
+    cache.insert(hashOf('b'), bcos::ref(code));
+    cache.insert(hashOf('c'), bcos::ref(code));
+    // a is referenced, so b is evicted first
+    auto a = cache.lookup(hashOf('a'));
+    BOOST_CHECK(a);
+    cache.insert(hashOf('d'), bcos::ref(code));
+    BOOST_CHECK(cache.lookup(hashOf('a')));
+    BOOST_CHECK(!cache.lookup(hashOf('b')));
+    BOOST_CHECK(cache.lookup(hashOf('c')));
+    BOOST_CHECK(cache.lookup(hashOf('d')));
+    BOOST_CHECK_EQUAL(cache.usage(), 900);
+
+    // an evicted code is still alive for the calls executing it
+    cache.insert(hashOf('e'), bcos::ref(code));
+    cache.insert(hashOf('f'), bcos::ref(code));
+    cache.insert(hashOf('g'), bcos::ref(code));
+    BOOST_CHECK(!cache.lookup(hashOf('a')));
+    BOOST_CHECK(a->code == code);
+    BOOST_CHECK_LE(cache.usage(), cache.capacity());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace bcos::test
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief unitest of the gas injector
+ * @file TestGasInjector.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-20
+ */
+
+#include "../../src/vm/gas_meter/GasInjector.h"
+#include "../liquid/hello_world.h"
+#include "../liquid/hello_world_caller.h"
+#include "../liquid/transfer.h"
+#include <tbb/task_arena.h>
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace bcos::wasm;
+
+namespace bcos::test
+{
+BOOST_AUTO_TEST_SUITE(testGasInjector)
+
+BOOST_AUTO_TEST_CASE(parallelMeteringIsSerialResult)
+{
+    vector<vector<uint8_t>> modules = {
+        vector<uint8_t>(hello_world_wasm, hello_world_wasm + hello_world_wasm_len),
+        vector<uint8_t>(
+            hello_world_caller_wasm, hello_world_caller_wasm + hello_world_caller_wasm_len),
+        vector<uint8_t>(transfer_wasm, transfer_wasm + transfer_wasm_len)};
+    GasInjector injector(GetInstructionTable());
+    for (auto& module : modules)
+    {
+        // one thread meters the functions one after another, as before the parallel metering
+        GasInjector::Result serial;
+        tbb::task_arena arena(1);
+        arena.execute([&]() { serial = injector.InjectMeter(module); });
+        BOOST_REQUIRE_EQUAL(serial.status, GasInjector::Status::Success);
+
+        for (auto i = 0; i < 4; ++i)
+        {
+            auto parallel = injector.InjectMeter(module);
+            BOOST_REQUIRE_EQUAL(parallel.status, GasInjector::Status::Success);
+            BOOST_CHECK(*parallel.byteCode == *serial.byteCode);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cachedByCodeHash)
+{
+    vector<uint8_t> module(transfer_wasm, transfer_wasm + transfer_wasm_len);
+    GasInjector injector(GetInstructionTable());
+    auto first = injector.InjectMeter(module, "transfer");
+    BOOST_REQUIRE_EQUAL(first.status, GasInjector::Status::Success);
+    BOOST_CHECK(*first.byteCode == *injector.InjectMeter(module).byteCode);
+    BOOST_CHECK_EQUAL(injector.cachedSize(), 1);
+
+    // deployed again, the cached result is returned
+    auto second = injector.InjectMeter(module, "transfer");
+    BOOST_CHECK_EQUAL(second.status, GasInjector::Status::Success);
+    BOOST_CHECK(second.byteCode == first.byteCode);
+    BOOST_CHECK_EQUAL(injector.cachedSize(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(failureNotCached)
+{
+    vector<uint8_t> invalid = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0xff};
+    GasInjector injector(GetInstructionTable());
+    for (auto i = 0; i < 16; ++i)
+    {
+        auto result = injector.InjectMeter(invalid, "invalid" + to_string(i));
+        BOOST_CHECK_EQUAL(result.status, GasInjector::Status::InvalidFormat);
+        BOOST_CHECK(!result.byteCode);
+    }
+    BOOST_CHECK_EQUAL(injector.cachedSize(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace bcos::test
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief unitest and benchmark of the VM instance cache
+ * @file TestVMFactory.cpp
+ * @author: xingqiangbai
+ * @date: 2021-12-15
+ */
+
+#include "../../src/vm/VMFactory.h"
+#include "../../src/vm/VMInstance.h"
+#include <evmone/evmone.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+using namespace bcos::executor;
+
+namespace bcos::test
+{
+// STOP, then unreachable PUSH1/JUMPDEST pairs to be analysed
+static bytes unreachableCode(size_t _codeSize)
+{
+    bytes code(_codeSize, 0x5b);
+    code[0] = 0x00;
+    for (size_t i = 1; i + 1 < _codeSize; i += 2)
+    {
+        code[i] = 0x60;
+    }
+    return code;
+}
+
+BOOST_AUTO_TEST_SUITE(testVMFactory)
+
+BOOST_AUTO_TEST_CASE(reuse)
+{
+    VMInstance* first = nullptr;
+    {
+        auto vm = VMFactory::acquire(VMKind::evmone);
+        first = vm.get();
+        // a call nested in a running VM leases another instance
+        auto nested = VMFactory::acquire(VMKind::evmone);
+        BOOST_CHECK(nested.get() != first);
+    }
+    // released in reverse order, the first instance is on the top of the cache
+    auto vm = VMFactory::acquire(VMKind::evmone);
+    BOOST_CHECK(vm.get() == first);
+
+    // another kind or another thread never gets it
+    auto hera = VMFactory::acquire(VMKind::Hera);
+    BOOST_CHECK(hera.get() != first);
+    VMInstance* other = nullptr;
+    std::thread([&other]() { other = VMFactory::acquire(VMKind::evmone).get(); }).join();
+    BOOST_CHECK(other != first);
+}
+
+BOOST_AUTO_TEST_CASE(tinyContract)
+{
+    // mstore(0, 1) return(0, 32), the contract timed by dispatchBench
+    const uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    auto vm = evmc_create_evmone();
+    evmc_message message{};
+    message.kind = EVMC_CALL;
+    message.gas = 1000000;
+    auto result = vm->execute(vm, nullptr, nullptr, EVMC_ISTANBUL, &message, code, sizeof(code));
+    BOOST_CHECK_EQUAL(result.status_code, EVMC_SUCCESS);
+    BOOST_REQUIRE_EQUAL(result.output_size, 32u);
+    BOOST_CHECK_EQUAL(result.output_data[31], 1);
+    if (result.release)
+    {
+        result.release(&result);
+    }
+    vm->destroy(vm);
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench
+BOOST_AUTO_TEST_CASE(
+    dispatchBench, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    size_t count = 10000;
+    for (auto kind : {VMKind::evmone, VMKind::Hera})
+    {
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto vm = VMFactory::create(kind);
+        }
+        auto createElapsed = chrono::steady_clock::now() - start;
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto vm = VMFactory::acquire(kind);
+        }
+        auto acquireElapsed = chrono::steady_clock::now() - start;
+        cout << "VMFactory kind: " << (kind == VMKind::evmone ? "evmone" : "hera")
+             << " create(ns/call): "
+             << chrono::duration_cast<chrono::nanoseconds>(createElapsed).count() / count
+             << " acquire(ns/call): "
+             << chrono::duration_cast<chrono::nanoseconds>(acquireElapsed).count() / count
+             << endl;
+    }
+
+    // a tiny contract which touches no host state: mstore(0, 1) return(0, 32)
+    const uint8_t code[] = {0x60, 0x01, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    auto vm = evmc_create_evmone();
+    evmc_message message{};
+    message.kind = EVMC_CALL;
+    message.gas = 1000000;
+    size_t succeeded = 0;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto result =
+            vm->execute(vm, nullptr, nullptr, EVMC_ISTANBUL, &message, code, sizeof(code));
+        succeeded += result.status_code == EVMC_SUCCESS ? 1 : 0;
+        if (result.release)
+        {
+            result.release(&result);
+        }
+    }
+    auto execElapsed = chrono::steady_clock::now() - start;
+    vm->destroy(vm);
+    cout << "tiny contract succeeded: " << succeeded << " exec(ns/call): "
+         << chrono::duration_cast<chrono::nanoseconds>(execElapsed).count() / count << endl;
+}
+
+BOOST_AUTO_TEST_CASE(stopBeforeUnreachableCode)
+{
+    auto vm = evmc_create_evmone();
+    evmc_message message{};
+    message.kind = EVMC_CALL;
+    message.gas = 1000000;
+    for (size_t codeSize : {16, 1024, 24576})
+    {
+        auto code = unreachableCode(codeSize);
+        auto result =
+            vm->execute(vm, nullptr, nullptr, EVMC_ISTANBUL, &message, code.data(), code.size());
+        BOOST_CHECK_EQUAL(result.status_code, EVMC_SUCCESS);
+        BOOST_CHECK_EQUAL(result.gas_left, message.gas);
+        if (result.release)
+        {
+            result.release(&result);
+        }
+    }
+    vm->destroy(vm);
+}
+
+// A timing run, disabled in the unit suite, run it by --run_test=@bench
+BOOST_AUTO_TEST_CASE(
+    analysisBench, *boost::unit_test::label("bench") * boost::unit_test::disabled())
+{
+    // evmone analyses the whole code on every execute(), so a call which returns at once costs
+    // more with more code, the difference is what an analysis cache across calls would save
+    auto vm = evmc_create_evmone();
+    evmc_message message{};
+    message.kind = EVMC_CALL;
+    message.gas = 1000000;
+    size_t count = 1000;
+    for (size_t codeSize : {16, 1024, 24576})
+    {
+        auto code = unreachableCode(codeSize);
+        size_t succeeded = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto result = vm->execute(
+                vm, nullptr, nullptr, EVMC_ISTANBUL, &message, code.data(), code.size());
+            succeeded += result.status_code == EVMC_SUCCESS ? 1 : 0;
+            if (result.release)
+            {
+                result.release(&result);
+            }
+        }
+        auto elapsed = chrono::steady_clock::now() - start;
+        cout << "evmone code size: " << codeSize << " succeeded: " << succeeded
+             << " exec of STOP(ns/call): "
+             << chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / count << endl;
+    }
+    vm->destroy(vm);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace bcos::test
@@ -28,6 +28,8 @@
 #include "src/validator.h"
 #include "src/wast-lexer.h"
 #include "vm/gas_meter/GasInjector.h"
+#include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -38,11 +40,57 @@ using namespace wabt;
 
 static std::unique_ptr<FileStream> s_log_stream;
 
+// inject the same module rounds times, without and with the result cache of the injector
+static int bench(const char* path, size_t rounds)
+{
+    std::vector<uint8_t> file_data;
+    if (!Succeeded(wabt::ReadFile(path, &file_data)))
+    {
+        cerr << "Read file failed" << endl;
+        return -1;
+    }
+    wasm::GasInjector injector(wasm::GetInstructionTable());
+    auto report = [&](const string& name, std::chrono::steady_clock::duration elapsed) {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        cout << name << " modules/s: " << rounds / seconds
+             << " MB/s: " << rounds * file_data.size() / seconds / 1024 / 1024 << endl;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        if (injector.InjectMeter(file_data).status != wasm::GasInjector::Status::Success)
+        {
+            cerr << "InjectMeter failed" << endl;
+            return -1;
+        }
+    }
+    report("InjectMeter", std::chrono::steady_clock::now() - start);
+
+    // any fixed key of the module stands for its code hash
+    auto codeHash = filesystem::path(path).filename().generic_string();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        if (injector.InjectMeter(file_data, codeHash).status != wasm::GasInjector::Status::Success)
+        {
+            cerr << "cached InjectMeter failed" << endl;
+            return -1;
+        }
+    }
+    report("cached InjectMeter", std::chrono::steady_clock::now() - start);
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
+    if (argc >= 3 && string(argv[1]) == "--bench")
+    {
+        return bench(argv[2], argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100);
+    }
     if (argc != 2)
     {
-        cerr << "The number of parameters not equal to 2" << endl;
+        cerr << "Usage: inject_meter <wasm file> | --bench <wasm file> [rounds]" << endl;
         return 0;
     }
     std::vector<uint8_t> file_data;